@@ -0,0 +1,83 @@
+#include "AllocationCounter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// The replacements live in their own file, so the compiler never inlines the std::free of a
+// delete next to the allocation of a new and mistakes them for a mismatched pair.
+
+static std::atomic<bool> enabled{false};
+static thread_local std::uint64_t threadAllocations = 0;
+
+static void* allocate(std::size_t size)
+{
+    if (enabled.load(std::memory_order_relaxed))
+    {
+        ++threadAllocations;
+    }
+    if (size == 0)
+    {
+        size = 1;
+    }
+    while (true)
+    {
+        if (auto ptr = std::malloc(size))
+        {
+            return ptr;
+        }
+        auto handler = std::get_new_handler();
+        if (handler == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+/**
+ * @brief Start counting the allocations.
+ */
+void AllocationCounter::enable()
+{
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get the number of allocations made by the calling thread.
+ * @return The allocations made since the counter was enabled.
+ */
+std::uint64_t AllocationCounter::count()
+{
+    return threadAllocations;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Count of the allocations made by each thread, for the pass profile.
+ *
+ * The global operator new is replaced to count the allocations. Until the counter is
+ * enabled, an allocation only pays for the check of a flag.
+ */
+class AllocationCounter
+{
+public:
+    static void enable();
+    static std::uint64_t count();
+};
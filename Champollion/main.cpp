@@ -9,19 +9,37 @@ namespace fs = std::filesystem;
 #include <format>
 
 #include <chrono>
-#include <future>
 #include <ctime>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
 
 #include "Pex/Binary.hpp"
 #include "Pex/FileReader.hpp"
 
 #include "Decompiler/AsmCoder.hpp"
+#include "Decompiler/BatchReader.hpp"
+#include "Decompiler/BoundedQueue.hpp"
+#include "Decompiler/ContentHash.hpp"
+#include "Decompiler/OutputCache.hpp"
 #include "Decompiler/PscCoder.hpp"
 
-#include "Decompiler/StreamWriter.hpp"
+#include "Decompiler/FileWriter.hpp"
+#include "Decompiler/PassProfile.hpp"
+#include "Decompiler/PscDecompiler.hpp"
+#include "Decompiler/Scheduler.hpp"
+#include "Decompiler/TraceSink.hpp"
 #include "Decompiler/Version.hpp"
+#include "AllocationCounter.hpp"
 #include "glob.hpp"
 
+// Decompiled functions, shared by all the scripts of the run.
+static Decompiler::FunctionCache functionCache;
+
 struct Params
 {
     bool outputAssembly;
@@ -37,9 +55,21 @@ struct Params
     bool printInfo;
     bool printCompileTime;
     bool debugLineComment;
+    size_t traceBudget;
+    bool profilePasses;
+    bool skipUnchanged;
+    bool dedupe;
+    bool functionCache;
+    std::uint32_t disabledPasses;
+    bool limitFunctions;
+    Decompiler::PscDecompiler::Limits limits;
 
     fs::path assemblyDir;
     fs::path papyrusDir;
+    fs::path cacheDir;
+    fs::path scheduleLog;
+    bool pipeline;
+    bool ioUring;
 
     fs::path parentDir{};
 
@@ -66,10 +96,29 @@ OptionsResult getProgramOptions(int argc, char* argv[], Params& params)
     params.printInfo = false;
     params.printCompileTime = false;
     params.debugLineComment = true;
+    params.traceBudget = 0;
+    params.profilePasses = false;
+    params.skipUnchanged = false;
+    params.dedupe = false;
+    params.functionCache = true;
+    params.disabledPasses = 0;
+    params.limitFunctions = false;
+    params.pipeline = false;
+    params.ioUring = true;
 
     params.assemblyDir = fs::current_path();
     params.papyrusDir = fs::current_path();
 
+    std::string optionalPasses;
+    for (auto& pass : Decompiler::PscDecompiler::getPasses())
+    {
+        if (pass.optional)
+        {
+            optionalPasses += (optionalPasses.empty() ? "" : ", ") + std::string(pass.name);
+        }
+    }
+    auto disablePassHelp = "Skip an optional decompilation pass (" + optionalPasses + "), can be repeated";
+
     std::string version_string = "Champollion PEX decompiler " + std::string(CHAMPOLLION_VERSION_STRING);
     options::options_description desc(version_string);
     desc.add_options()
@@ -81,8 +130,21 @@ OptionsResult getProgramOptions(int argc, char* argv[], Params& params)
             ("comment,c", "Output assembly in comments of the decompiled psc file")
             ("header,e", "Write header to decompiled psc file")
             ("threaded,t", "Run decompilation in parallel mode")
-            ("trace,g", "Trace the decompilation and output results to rebuild log")
+            ("trace,g", "Trace the decompilation and output results to one rebuild log per script")
             ("no-dump-tree", "Do not dump tree for each node during decompilation tracing (requires --trace)")
+            ("trace-budget", options::value<size_t>(), "Write the flight record of the functions taking longer than this many milliseconds to decompile (default 0, disabled)")
+            ("profile-passes", "Print the time, block and node counts and allocations of each decompilation pass")
+            ("disable-pass", options::value<std::vector<std::string>>(), disablePassHelp.c_str())
+            ("function-time-limit", options::value<size_t>(), "Write the functions taking longer than this many milliseconds to decompile as commented assembly (0 for no limit)")
+            ("function-node-limit", options::value<size_t>(), "Write the functions whose tree has more than this many nodes as commented assembly (0 for no limit)")
+            ("function-depth-limit", options::value<size_t>(), "Write the functions whose control flow is nested deeper than this as commented assembly (0 for no limit)")
+            ("pipeline", "With --threaded, overlap the directory walk, the reads, the decompilation and the writes, the files are taken in directory order")
+            ("no-io-uring", "With --pipeline, read the files with pread instead of io_uring (Linux only)")
+            ("schedule-log", options::value<std::string>(), "Order the files of a threaded run by their times in this timing log instead of their sizes, and update it")
+            ("dedupe", "Decompile the files with the same content once, and copy the outputs to the other files")
+            ("skip-unchanged", "Leave the output files whose content did not change untouched")
+            ("cache", options::value<std::string>(), "Reuse the scripts decompiled by the previous runs, stored in this directory")
+            ("no-function-cache", "Decompile every function, even when an identical function was already decompiled")
             ("debug-funcs,d", "Decompile debug and compiler-generated functions (default false)")
             ("no-debug-line", "Do not comment with debug info line numbers on script lines (default false)")
             ("print-info,i", "Print header info from the specified PEX file(s) and exit")
@@ -127,6 +189,8 @@ OptionsResult getProgramOptions(int argc, char* argv[], Params& params)
     params.outputComment = (args.count("comment") != 0);
     params.writeHeader = (args.count("header") != 0);
     params.parallel = (args.count("threaded") != 0);
+    params.pipeline = (args.count("pipeline") != 0);
+    params.ioUring = (args.count("no-io-uring") == 0);
     params.traceDecompilation = (args.count("trace") != 0);
     params.dumpTree = params.traceDecompilation && args.count("no-dump-tree") == 0;
     params.recursive = (args.count("recursive") != 0);
@@ -136,6 +200,56 @@ OptionsResult getProgramOptions(int argc, char* argv[], Params& params)
     params.printCompileTime = (args.count("print-compile-time") != 0);
     params.debugLineComment = !(args.count("no-debug-line") != 0);
     params.verbose = (args.count("verbose") != 0);
+    if (args.count("trace-budget"))
+    {
+        params.traceBudget = args["trace-budget"].as<size_t>();
+    }
+    params.profilePasses = (args.count("profile-passes") != 0);
+    // With any of the limits, the functions failing to decompile are written as assembly as well
+    if (args.count("function-time-limit"))
+    {
+        params.limits.time = std::chrono::milliseconds(args["function-time-limit"].as<size_t>());
+        params.limitFunctions = true;
+    }
+    if (args.count("function-node-limit"))
+    {
+        params.limits.nodes = args["function-node-limit"].as<size_t>();
+        params.limitFunctions = true;
+    }
+    if (args.count("function-depth-limit"))
+    {
+        params.limits.depth = args["function-depth-limit"].as<size_t>();
+        params.limitFunctions = true;
+    }
+    params.skipUnchanged = (args.count("skip-unchanged") != 0);
+    params.dedupe = (args.count("dedupe") != 0);
+    params.functionCache = (args.count("no-function-cache") == 0);
+    if (args.count("cache"))
+    {
+        params.cacheDir = fs::path(args["cache"].as<std::string>());
+    }
+    if (args.count("schedule-log"))
+    {
+        params.scheduleLog = fs::path(args["schedule-log"].as<std::string>());
+    }
+    if (args.count("disable-pass"))
+    {
+        auto& passes = Decompiler::PscDecompiler::getPasses();
+        for (auto& name : args["disable-pass"].as<std::vector<std::string>>())
+        {
+            size_t i = 0;
+            while (i < passes.size() && (!passes[i].optional || name != passes[i].name))
+            {
+                ++i;
+            }
+            if (i == passes.size())
+            {
+                std::cout << name << " is not an optional decompilation pass" << std::endl;
+                return Invalid;
+            }
+            params.disabledPasses |= 1u << i;
+        }
+    }
     if (!params.printInfo) {
       try {
         if (args.count("asm")) {
@@ -198,25 +312,140 @@ struct _ProcessResults{
     std::vector<std::string> output;
     bool isStarfield = false;
     bool failed = false;
+    bool cached = false;
+    size_t written = 0;
+    size_t unchanged = 0;
+    size_t fallbacks = 0; // functions written as assembly
+    fs::path asmFile; // empty if not written
+    fs::path pscFile; // empty if not written
+    std::string scriptPath;
+    Decompiler::PassProfile profile;
 };
 
 typedef _ProcessResults ProcessResults;
-ProcessResults processFile(fs::path file, Params params)
+
+/**
+ * @brief Get the path of the decompiled script.
+ * @param file PEX file.
+ * @param scriptPath Path made of the object name, used to recreate the directory structure. Empty if not used.
+ * @param params Options of the run.
+ */
+fs::path getPscFile(const fs::path& file, const std::string& scriptPath, const Params& params)
+{
+    fs::path dir_structure;
+    if (!scriptPath.empty()){
+        dir_structure = fs::path(scriptPath).remove_filename();
+    } else if (!params.parentDir.empty()) {
+      dir_structure = fs::relative(file, params.parentDir).remove_filename();
+    }
+    fs::path basedir = !dir_structure.empty() ? (params.papyrusDir / dir_structure) : params.papyrusDir;
+    fs::path fileName = fs::path(file.filename()).replace_extension(".psc");
+    return basedir / fileName;
+}
+
+/**
+ * @brief Check if the outputs of a run are taken from the cache.
+ * The traces, the tree dumps and the profile need the decompilation to run, they bypass the cache.
+ * @param params Options of the run.
+ */
+bool usesCache(const Params& params)
+{
+    return !params.cacheDir.empty() && !params.printInfo && !params.printCompileTime
+           && !params.traceDecompilation && !params.dumpTree && !params.profilePasses && params.traceBudget == 0;
+}
+
+/**
+ * @brief Output of a file decompiled in a pipeline, committed by the writer stage.
+ * The output is stored in the cache once committed, if it has a cache key.
+ */
+struct DeferredOutput
+{
+    std::unique_ptr<Decompiler::FileWriter> writer;
+    std::string cacheKey;
+    std::string cacheExtension;
+};
+
+/**
+ * @brief Store a committed output in the cache.
+ * The output is already written, a failure is a warning and only costs the next run.
+ *
+ * @param cache Cache of the outputs.
+ * @param key Key of the output.
+ * @param extension Extension of the output, "psc" or "pas".
+ * @param content Content of the output.
+ * @param file PEX file of the output.
+ * @param[in,out] result Receives the warning.
+ */
+void storeOutput(const Decompiler::OutputCache& cache, const std::string& key, const std::string& extension,
+                 const std::string& content, const fs::path& file, ProcessResults& result)
 {
-    ProcessResults result;
-    Pex::Binary pex;
     try
     {
-        Pex::FileReader reader(file.string());
-        reader.read(pex);
-        pex.sort();
+        cache.store(key, extension, content);
     }
-    catch(std::exception& ex)
+    catch (const std::exception& ex)
     {
-       result.output.push_back(std::format("ERROR: {} : {}", file.string(), ex.what()));
-       result.failed = true;
-       return result;
+        result.output.push_back(std::format("WARNING: {} : {}", file.string(), ex.what()));
     }
+}
+
+/**
+ * @brief Parse a PEX file already in memory.
+ * @param content Bytes of the file.
+ * @param useCache True to hash the content of the file for the keys of the cache.
+ * @param[out] pex Receives the content of the file.
+ * @param[out] contentHash Receives the hash of the content, if useCache is true.
+ */
+void parseFile(const std::string& content, bool useCache, Pex::Binary& pex, std::string& contentHash)
+{
+    if (useCache)
+    {
+        contentHash = Decompiler::ContentHash::of(content);
+    }
+    Pex::FileReader reader(content.data(), content.size());
+    reader.read(pex);
+}
+
+/**
+ * @brief Read a PEX file.
+ * @param file PEX file.
+ * @param useCache True to hash the content of the file for the keys of the cache.
+ * @param[out] pex Receives the content of the file.
+ * @param[out] contentHash Receives the hash of the content, if useCache is true.
+ */
+void readFile(const fs::path& file, bool useCache, Pex::Binary& pex, std::string& contentHash)
+{
+    if (useCache)
+    {
+        // The file is read once, for the cache key and for the parsing
+        std::ifstream stream(file, std::ios::binary);
+        std::ostringstream bytes;
+        if (!stream || !(bytes << stream.rdbuf()))
+        {
+            throw std::runtime_error("Failed to read the file");
+        }
+        parseFile(bytes.str(), useCache, pex, contentHash);
+    }
+    else
+    {
+        Pex::FileReader reader(file.string());
+        reader.read(pex);
+    }
+}
+
+/**
+ * @brief Decompile and disassemble a PEX file already read.
+ * @param file PEX file.
+ * @param pex Content of the file.
+ * @param contentHash Hash of the content, for the keys of the cache.
+ * @param params Options of the run.
+ * @param deferred If not null, receives the outputs to commit and store in the cache instead of committing them.
+ */
+ProcessResults decompileFile(const fs::path& file, Pex::Binary& pex, const std::string& contentHash,
+                             const Params& params, std::vector<DeferredOutput>* deferred)
+{
+    ProcessResults result;
+    bool useCache = usesCache(params);
     pex.getGameType() == Pex::Binary::StarfieldScript ? result.isStarfield = true : result.isStarfield = false;
     if (params.printInfo)
     {
@@ -260,46 +489,88 @@ ProcessResults processFile(fs::path file, Params params)
         result.output.push_back(std::format("{}: {}", file.string(), time));
         return result;
     }
+    // The scripts are only sorted when one of them is not in the cache
+    bool sorted = false;
+    auto sort = [&pex, &sorted]() {
+        if (!sorted)
+        {
+            pex.sort();
+            sorted = true;
+        }
+    };
+    Decompiler::OutputCache cache(params.cacheDir.string());
+    auto cacheKey = [&contentHash](const std::string& output) {
+        return Decompiler::ContentHash().update(contentHash).update(CHAMPOLLION_VERSION_STRING).update(output).toString();
+    };
+    std::string cachedContent;
+    auto commit = [&result, &params, deferred](Decompiler::FileWriter* writer) {
+        if (deferred)
+        {
+            // The coder owns its writer, the content is handed over to a writer of the last stage
+            deferred->push_back(DeferredOutput{std::make_unique<Decompiler::FileWriter>(writer->getPath()), "", ""});
+            deferred->back().writer->setSkipUnchanged(params.skipUnchanged);
+            deferred->back().writer->writeContent(writer->getContent());
+            return;
+        }
+        writer->commit() ? ++result.written : ++result.unchanged;
+    };
+    // Called after the commit of the output, the deferred outputs are stored once the writer stage commits them
+    auto store = [&cache, &result, &file, deferred](const std::string& key, const std::string& extension,
+                                                    const std::string& content) {
+        if (deferred)
+        {
+            deferred->back().cacheKey = key;
+            deferred->back().cacheExtension = extension;
+            return;
+        }
+        storeOutput(cache, key, extension, content, file, result);
+    };
+
     if (params.outputAssembly)
     {
         fs::path asmFile = params.assemblyDir / file.filename().replace_extension(".pas");
         try
         {
-            std::ofstream asmStream(asmFile.string());
-            Decompiler::AsmCoder asmCoder(new Decompiler::StreamWriter(asmStream));
+            auto asmWriter = new Decompiler::FileWriter(asmFile.string());
+            asmWriter->setSkipUnchanged(params.skipUnchanged);
+            Decompiler::AsmCoder asmCoder(asmWriter);
 
-            asmCoder.code(pex);
+            auto key = useCache ? cacheKey("pas") : std::string();
+            if (useCache && cache.load(key, "pas", cachedContent))
+            {
+                asmWriter->writeContent(cachedContent);
+                commit(asmWriter);
+            }
+            else
+            {
+                sort();
+                asmCoder.code(pex);
+                commit(asmWriter);
+                if (useCache)
+                {
+                    store(key, "pas", asmWriter->getContent());
+                }
+            }
+            result.asmFile = asmFile;
             result.output.push_back(std::format("{} dissassembled to {}", file.string(), asmFile.string()));
         }
         catch(std::exception& ex)
         {
             result.output.push_back(std::format("ERROR: {} : {}", file.string(), ex.what()));
             result.failed = true;
-            fs::remove(asmFile);
         }
     }
-    fs::path dir_structure;
     if (params.recreateDirStructure && (pex.getGameType() == Pex::Binary::Fallout4Script || pex.getGameType() == Pex::Binary::StarfieldScript) && pex.getObjects().size() > 0){
-        std::string script_path = pex.getObjects()[0].getName().asString();
-        std::replace(script_path.begin(), script_path.end(), ':', '/');
-        dir_structure = fs::path(script_path).remove_filename();
-    } else if (!params.parentDir.empty()) {
-      dir_structure = fs::relative(file, params.parentDir).remove_filename();
+        result.scriptPath = pex.getObjects()[0].getName().asString();
+        std::replace(result.scriptPath.begin(), result.scriptPath.end(), ':', '/');
     }
-    fs::path basedir = !dir_structure.empty() ? (params.papyrusDir / dir_structure) : params.papyrusDir;
-    if (!dir_structure.empty()){
-        fs::create_directories(basedir);
-    }
-    fs::path fileName = file.filename().replace_extension(".psc");
-    fs::path pscFile = basedir / fileName;
+    fs::path pscFile = getPscFile(file, result.scriptPath, params);
     try
     {   
-        std::ofstream pscStream(pscFile);
-        if (pscStream.fail()){
-            throw std::runtime_error(std::format("Failed to open {} for writing", pscFile.string()));
-        }
+        auto pscWriter = new Decompiler::FileWriter(pscFile.string());
+        pscWriter->setSkipUnchanged(params.skipUnchanged);
         Decompiler::PscCoder pscCoder(
-                new Decompiler::StreamWriter(pscStream),
+                pscWriter,
                 params.outputComment,
                 params.writeHeader,
                 params.traceDecompilation,
@@ -307,22 +578,137 @@ ProcessResults processFile(fs::path file, Params params)
                 params.decompileDebugFuncs,
                 params.debugLineComment,
                 params.papyrusDir.string()); // using string instead of path here for C++14 compatability for staticlib targets
+        pscCoder.outputTraceBudget(std::chrono::milliseconds(params.traceBudget));
+        pscCoder.outputPassProfile(params.profilePasses ? &result.profile : nullptr);
+        pscCoder.disablePasses(params.disabledPasses);
+        pscCoder.useFunctionCache(params.functionCache ? &functionCache : nullptr);
+        pscCoder.limitFunctions(params.limitFunctions ? &params.limits : nullptr);
 
-        pscCoder.code(pex);
+        auto key = useCache ? cacheKey(std::format("psc {:d}{:d}{:d}{:d} {}", params.outputComment, params.writeHeader,
+                                                   params.decompileDebugFuncs, params.debugLineComment,
+                                                   params.disabledPasses))
+                            : std::string();
+        if (useCache && cache.load(key, "psc", cachedContent))
+        {
+            pscWriter->writeContent(cachedContent);
+            commit(pscWriter);
+            result.cached = true;
+        }
+        else
+        {
+            sort();
+            pscCoder.code(pex);
+            commit(pscWriter);
+            result.fallbacks = pscCoder.getFallbackCount();
+            // The limits may not be exceeded by the next run, the assembly is not kept
+            if (useCache && result.fallbacks == 0)
+            {
+                store(key, "psc", pscWriter->getContent());
+            }
+        }
+        result.pscFile = pscFile;
         result.output.push_back(std::format("{} decompiled to {}", file.string(), pscFile.string()));
+        if (result.fallbacks > 0)
+        {
+            result.output.push_back(std::format("WARNING: {} : {} functions written as assembly", file.string(),
+                                                result.fallbacks));
+        }
+        if (!result.profile.empty())
+        {
+            result.profile.write(result.output);
+        }
     }
     catch(std::exception& ex)
     {
         result.output.push_back(std::format("ERROR: {} : {}", file.string() , ex.what()));
         result.failed = true;
-        fs::remove(pscFile);
     }
     return result;
 
 }
+
+ProcessResults processFile(fs::path file, Params params)
+{
+    Pex::Binary pex;
+    std::string contentHash;
+    try
+    {
+        readFile(file, usesCache(params), pex, contentHash);
+    }
+    catch(std::exception& ex)
+    {
+        ProcessResults result;
+        result.output.push_back(std::format("ERROR: {} : {}", file.string(), ex.what()));
+        result.failed = true;
+        return result;
+    }
+    return decompileFile(file, pex, contentHash, params, nullptr);
+}
+/**
+ * @brief Write the outputs of a file from the outputs of another file with the same content.
+ * @param file PEX file.
+ * @param original Result of the file with the same content.
+ * @param params Options of the run.
+ */
+ProcessResults copyOutputs(fs::path file, const ProcessResults& original, Params params)
+{
+    ProcessResults result;
+    result.isStarfield = original.isStarfield;
+    result.scriptPath = original.scriptPath;
+    auto copy = [&result, &params](const fs::path& from, const fs::path& to) {
+        // Text mode on both sides, the writer keeps the platform line breaks
+        std::ifstream stream(from);
+        std::ostringstream content;
+        if (!stream || !(content << stream.rdbuf()))
+        {
+            throw std::runtime_error("Failed to read " + from.string());
+        }
+        Decompiler::FileWriter writer(to.string());
+        writer.setSkipUnchanged(params.skipUnchanged);
+        writer.writeContent(content.str());
+        writer.commit() ? ++result.written : ++result.unchanged;
+    };
+    try
+    {
+        if (!original.asmFile.empty())
+        {
+            result.asmFile = params.assemblyDir / file.filename().replace_extension(".pas");
+            if (result.asmFile != original.asmFile)
+            {
+                copy(original.asmFile, result.asmFile);
+            }
+        }
+        if (!original.pscFile.empty())
+        {
+            result.pscFile = getPscFile(file, result.scriptPath, params);
+            if (result.pscFile != original.pscFile)
+            {
+                copy(original.pscFile, result.pscFile);
+            }
+            result.output.push_back(std::format("{} copied to {}", file.string(), result.pscFile.string()));
+        }
+    }
+    catch(std::exception& ex)
+    {
+        result.output.push_back(std::format("ERROR: {} : {}", file.string(), ex.what()));
+        result.failed = true;
+    }
+    if (original.failed)
+    {
+        result.output.push_back(std::format("ERROR: {} : same content as a file which failed to decompile", file.string()));
+        result.failed = true;
+    }
+    return result;
+}
+
 size_t countFiles = 0;
 size_t failedFiles = 0;
+size_t cachedFiles = 0;
+size_t writtenFiles = 0;
+size_t unchangedFiles = 0;
+size_t fallbackFunctions = 0;
 bool printStarfieldWarning = false;
+Decompiler::PassProfile runProfile;
 
 void processResult(const ProcessResults &result, const Params& params)
 {
@@ -330,6 +716,13 @@ void processResult(const ProcessResults &result, const Params& params)
     if (!printStarfieldWarning && result.isStarfield){
       printStarfieldWarning = true;
     }
+    runProfile.merge(result.profile);
+    if (result.cached){
+      ++cachedFiles;
+    }
+    writtenFiles += result.written;
+    unchangedFiles += result.unchanged;
+    fallbackFunctions += result.fallbacks;
     if (result.failed){
       ++failedFiles;
       for (auto line : result.output)
@@ -344,6 +737,340 @@ void processResult(const ProcessResults &result, const Params& params)
     }
 }
 
+struct InputFile
+{
+    fs::path path;
+    fs::path parentDir;
+};
+
+/**
+ * @brief Walk the PEX files given on the command line.
+ * @param params Options of the run.
+ * @param visit Called for each file, with the directory its output path is relative to.
+ */
+void walkInputs(const Params& params, const std::function<void(InputFile)>& visit)
+{
+    for (auto& path : params.inputs)
+    {
+        if (params.recursive && fs::is_directory(path)){
+            for (auto& entry : fs::recursive_directory_iterator(path)){
+                if (fs::is_regular_file(entry) && _stricmp(entry.path().extension().string().c_str(), ".pex") == 0){
+                    visit(InputFile{entry.path(), path});
+                }
+            }
+        } else if (fs::is_directory(path)){
+            for (auto& entry : fs::directory_iterator(path)){
+                if (_stricmp(entry.path().extension().string().c_str(), ".pex") == 0){
+                    visit(InputFile{entry.path(), fs::path()});
+                }
+            }
+        } else {
+            visit(InputFile{path, fs::path()});
+        }
+    }
+}
+
+/**
+ * @brief List the PEX files given on the command line.
+ * @param params Options of the run.
+ * @return The files, with the directory their output path is relative to.
+ */
+std::vector<InputFile> collectInputs(const Params& params)
+{
+    std::vector<InputFile> files;
+    walkInputs(params, [&files](InputFile file) {
+        files.push_back(std::move(file));
+    });
+    return files;
+}
+
+/**
+ * @brief File going through the stages of the pipeline.
+ */
+struct PipelineJob
+{
+    size_t index;
+    InputFile input;
+    std::unique_ptr<Pex::Binary> pex;
+    std::string contentHash;
+    ProcessResults result;
+    std::vector<DeferredOutput> outputs;
+};
+
+/**
+ * @brief Decompile the files in a pipeline overlapping the directory walk, the reads, the decompilation and the writes.
+ *
+ * A walker thread lists the files, reader threads read them by batches and parse them from memory, decompiler
+ * threads write the outputs in memory and writer threads commit them to disk. The bounded queues between the stages hold back the stages running ahead,
+ * so the memory stays bounded while the disk and the processors are busy at the same time.
+ *
+ * @param params Options of the run.
+ * @return The results, in the order of the walk.
+ */
+std::vector<ProcessResults> processPipelined(const Params& params)
+{
+    typedef std::unique_ptr<PipelineJob> Job;
+    auto decompilers = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    // The readers read the files by batches, a few of them keep the disk busy
+    const size_t readers = 2;
+    const size_t readBatch = 32;
+    const size_t writers = 2;
+    Decompiler::BoundedQueue<Job> paths(1024);
+    Decompiler::BoundedQueue<Job> binaries(decompilers * 2);
+    Decompiler::BoundedQueue<Job> outputs(decompilers * 2);
+    std::mutex mutex;
+    std::vector<ProcessResults> results;
+    auto useCache = usesCache(params);
+
+    std::thread walker([&]() {
+        size_t index = 0;
+        try
+        {
+            walkInputs(params, [&](InputFile input) {
+                auto job = std::make_unique<PipelineJob>();
+                job->index = index++;
+                job->input = std::move(input);
+                paths.push(std::move(job));
+            });
+        }
+        catch (const std::exception& ex)
+        {
+            // The files found so far are still decompiled
+            std::cerr << "ERROR: " << ex.what() << std::endl;
+        }
+    });
+    auto read = [&]() {
+        Decompiler::BatchReader reader(params.ioUring);
+        std::vector<Job> jobs;
+        std::vector<Decompiler::BatchReader::File> files;
+        while (paths.pop(jobs, readBatch))
+        {
+            files.resize(jobs.size());
+            for (size_t i = 0; i < jobs.size(); ++i)
+            {
+                files[i].path = jobs[i]->input.path;
+                files[i].content.clear();
+                files[i].error.clear();
+            }
+            try
+            {
+                reader.read(files);
+            }
+            catch (std::exception& ex)
+            {
+                for (auto& file : files)
+                {
+                    file.error = ex.what();
+                }
+            }
+            for (size_t i = 0; i < jobs.size(); ++i)
+            {
+                auto& job = jobs[i];
+                try
+                {
+                    if (!files[i].error.empty())
+                    {
+                        throw std::runtime_error(files[i].error);
+                    }
+                    job->pex = std::make_unique<Pex::Binary>();
+                    parseFile(files[i].content, useCache, *job->pex, job->contentHash);
+                }
+                catch (std::exception& ex)
+                {
+                    job->pex.reset();
+                    job->result.output.push_back(std::format("ERROR: {} : {}", job->input.path.string(), ex.what()));
+                    job->result.failed = true;
+                }
+                files[i].content.clear();
+                binaries.push(std::move(job));
+            }
+            jobs.clear();
+        }
+    };
+    auto decompile = [&]() {
+        Job job;
+        while (binaries.pop(job))
+        {
+            if (job->pex)
+            {
+                auto fileParams = params;
+                fileParams.parentDir = job->input.parentDir;
+                job->result = decompileFile(job->input.path, *job->pex, job->contentHash, fileParams, &job->outputs);
+                job->pex.reset();
+            }
+            outputs.push(std::move(job));
+        }
+    };
+    auto write = [&]() {
+        Decompiler::OutputCache cache(params.cacheDir.string());
+        Job job;
+        while (outputs.pop(job))
+        {
+            for (auto& output : job->outputs)
+            {
+                try
+                {
+                    output.writer->commit() ? ++job->result.written : ++job->result.unchanged;
+                }
+                catch (std::exception& ex)
+                {
+                    job->result.output.push_back(std::format("ERROR: {} : {}", job->input.path.string(), ex.what()));
+                    job->result.failed = true;
+                    continue;
+                }
+                if (!output.cacheKey.empty())
+                {
+                    storeOutput(cache, output.cacheKey, output.cacheExtension, output.writer->getContent(),
+                                job->input.path, job->result);
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (results.size() <= job->index)
+            {
+                results.resize(job->index + 1);
+            }
+            results[job->index] = std::move(job->result);
+        }
+    };
+
+    // Each stage is joined before closing the queue it feeds
+    auto start = [](size_t count, const std::function<void()>& body) {
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < count; ++i)
+        {
+            threads.emplace_back(body);
+        }
+        return threads;
+    };
+    auto join = [](std::vector<std::thread>& threads) {
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    };
+    auto readThreads = start(readers, read);
+    auto decompileThreads = start(decompilers, decompile);
+    auto writeThreads = start(writers, write);
+    walker.join();
+    paths.close();
+    join(readThreads);
+    binaries.close();
+    join(decompileThreads);
+    outputs.close();
+    join(writeThreads);
+    return results;
+}
+
+/**
+ * @brief Decompile files in parallel, the most expensive first.
+ * @param inputs Files of the run.
+ * @param selected Indices of the files to decompile in inputs.
+ * @param params Options of the run.
+ * @return The results of the selected files, in the order of selected.
+ */
+std::vector<ProcessResults> processScheduled(const std::vector<InputFile>& inputs, const std::vector<size_t>& selected,
+                                             const Params& params)
+{
+    Decompiler::Scheduler scheduler;
+    if (!params.scheduleLog.empty())
+    {
+        scheduler.loadTimes(params.scheduleLog.string());
+    }
+    for (auto i : selected)
+    {
+        scheduler.add(inputs[i].path);
+    }
+    std::vector<ProcessResults> results(selected.size());
+    scheduler.run(std::thread::hardware_concurrency(), [&](size_t s) {
+        auto fileParams = params;
+        fileParams.parentDir = inputs[selected[s]].parentDir;
+        results[s] = processFile(inputs[selected[s]].path, fileParams);
+    });
+    if (!params.scheduleLog.empty())
+    {
+        try
+        {
+            scheduler.saveTimes(params.scheduleLog.string());
+        }
+        catch (const std::exception& ex)
+        {
+            std::cout << "WARNING: " << ex.what() << std::endl;
+        }
+    }
+    return results;
+}
+
+size_t duplicateFiles = 0;
+size_t duplicatedScripts = 0;
+
+/**
+ * @brief Decompile the files with the same content once.
+ * The files are hashed first, the first file of each content is decompiled and its outputs
+ * are copied to the other files.
+ *
+ * @param params Options of the run.
+ */
+void processDeduplicated(const Params& params)
+{
+    auto inputs = collectInputs(params);
+    std::unordered_map<std::string, size_t> firstByContent;
+    std::vector<size_t> originals(inputs.size());
+    std::vector<size_t> uniques;
+    std::vector<bool> duplicated(inputs.size(), false);
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        std::ifstream stream(inputs[i].path, std::ios::binary);
+        std::ostringstream bytes;
+        // An unreadable file is its own content, processFile reports the error
+        auto key = stream && (bytes << stream.rdbuf()) ? Decompiler::ContentHash::of(bytes.str())
+                                                       : inputs[i].path.string();
+        auto inserted = firstByContent.emplace(key, i);
+        originals[i] = inserted.first->second;
+        if (inserted.second)
+        {
+            uniques.push_back(i);
+        }
+        else
+        {
+            duplicated[originals[i]] = true;
+        }
+    }
+
+    auto paramsOf = [&params, &inputs](size_t i) {
+        auto fileParams = params;
+        fileParams.parentDir = inputs[i].parentDir;
+        return fileParams;
+    };
+    std::vector<ProcessResults> results(inputs.size());
+    if (params.parallel)
+    {
+        auto scheduled = processScheduled(inputs, uniques, params);
+        for (size_t u = 0; u < uniques.size(); ++u)
+        {
+            results[uniques[u]] = std::move(scheduled[u]);
+        }
+    }
+    else
+    {
+        for (auto i : uniques)
+        {
+            results[i] = processFile(inputs[i].path, paramsOf(i));
+        }
+    }
+    for (auto i : uniques)
+    {
+        processResult(results[i], params);
+        duplicatedScripts += duplicated[i];
+    }
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        if (originals[i] != i)
+        {
+            processResult(copyOutputs(inputs[i].path, results[originals[i]], paramsOf(i)), params);
+            ++duplicateFiles;
+        }
+    }
+}
 
 int main(int argc, char* argv[])
 {
@@ -352,9 +1079,30 @@ int main(int argc, char* argv[])
     auto result = getProgramOptions(argc, argv, args);
     if (result == Good)
     {
+        if (args.profilePasses)
+        {
+            AllocationCounter::enable();
+            Decompiler::PassProfile::setAllocationCounter(AllocationCounter::count);
+        }
         auto start = std::chrono::steady_clock::now();
+        auto functionCacheFile = (args.cacheDir / "functions.cache").string();
+        if (args.functionCache && !args.cacheDir.empty())
+        {
+            try
+            {
+                functionCache.load(functionCacheFile);
+            }
+            catch (const std::exception& ex)
+            {
+                std::cout << "WARNING: " << ex.what() << std::endl;
+            }
+        }
+        if (args.dedupe && !args.printInfo && !args.printCompileTime)
+        {
+            processDeduplicated(args);
+        }
         // ignore parallel if we are printing info
-        if(!args.parallel || args.printInfo || args.printCompileTime)
+        else if(!args.parallel || args.printInfo || args.printCompileTime)
         {
             for (auto path : args.inputs)
             {
@@ -386,51 +1134,46 @@ int main(int argc, char* argv[])
                 }
             }
         }
+        else if (args.pipeline)
+        {
+            auto results = processPipelined(args);
+            for (auto& result : results)
+            {
+                processResult(result, args);
+            }
+            countFiles = results.size();
+        }
         else
         {
-            std::vector<std::future<ProcessResults>> results;
-            for (auto& path : args.inputs)
+            // The files are decompiled largest first, the results are reported in the order of the inputs
+            auto inputs = collectInputs(args);
+            std::vector<size_t> all(inputs.size());
+            for (size_t i = 0; i < all.size(); ++i)
             {
-
-                if (args.recursive && fs::is_directory(path)){
-                  args.parentDir = path;
-                  // recursively get all files in the directory
-                  for (auto& entry : fs::recursive_directory_iterator(path)){
-                    if (fs::is_regular_file(entry) && _stricmp(entry.path().extension().string().c_str(), ".pex") == 0){
-                        results.push_back(std::move(std::async(std::launch::async, processFile, fs::path(entry.path()), args)));
-                    }
-                  }
-                }
-                else if (fs::is_directory(path))
-                {
-                    args.parentDir = fs::path();
-                    fs::directory_iterator end;
-                    fs::directory_iterator entry(path);
-                    while(entry != end)
-                    {
-                        if (_stricmp(entry->path().extension().string().c_str(), ".pex") == 0)
-                        {
-
-                            results.push_back(std::move(std::async(std::launch::async, processFile, fs::path(entry->path()), args)));
-                        }
-                        entry++;
-                    }
-                }
-                else
-                {
-                    args.parentDir = fs::path();
-                    results.push_back(std::move(std::async(std::launch::async, processFile, path, args)));
-                }
+                all[i] = i;
             }
-
+            auto results = processScheduled(inputs, all, args);
             for (auto& result : results)
             {
-                auto pResult = result.get();
-                processResult(pResult, args);
+                processResult(result, args);
             }
             countFiles = results.size();
 
         }
+        // Rebuild logs and flight records of failed functions are written in the background.
+        Decompiler::TraceSink::instance().flush();
+        if (args.functionCache && !args.cacheDir.empty() && functionCache.isModified())
+        {
+            try
+            {
+                Decompiler::FileWriter::createDirectories(args.cacheDir.string());
+                functionCache.save(functionCacheFile);
+            }
+            catch (const std::exception& ex)
+            {
+                std::cout << "WARNING: " << ex.what() << std::endl;
+            }
+        }
         auto end = std::chrono::steady_clock::now();
         auto diff = end - start;
 
@@ -438,6 +1181,32 @@ int main(int argc, char* argv[])
         if (failedFiles > 0){
             std::cout << failedFiles << " files failed to decompile." << std::endl;
         }
+        if (fallbackFunctions > 0){
+            std::cout << fallbackFunctions << " functions written as assembly, see the flight records." << std::endl;
+        }
+        if (!args.cacheDir.empty()){
+            std::cout << cachedFiles << " files taken from the cache." << std::endl;
+        }
+        if (args.verbose && args.functionCache){
+            std::cout << functionCache.getHits() << " functions taken from the function cache, "
+                      << functionCache.getMisses() << " decompiled." << std::endl;
+        }
+        if (args.dedupe){
+            std::cout << duplicateFiles << " duplicate files of " << duplicatedScripts << " scripts copied instead of decompiled." << std::endl;
+        }
+        if (args.skipUnchanged){
+            std::cout << writtenFiles << " output files written, " << unchangedFiles << " unchanged." << std::endl;
+        }
+        if (!runProfile.empty()){
+            std::vector<std::string> lines;
+            runProfile.write(lines);
+            std::cout << "Decompilation passes:" << std::endl;
+            for (auto& line : lines)
+            {
+                std::cout << line << '\n';
+            }
+            std::cout << std::endl;
+        }
         if (countFiles > 0 && countFiles != failedFiles){
           if (args.outputAssembly){
             std::cout << "Disassembled scripts written to " << args.assemblyDir.string() << std::endl;
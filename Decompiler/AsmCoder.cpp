@@ -1,10 +1,6 @@
 #include "AsmCoder.hpp"
 
 #include <cassert>
-#include <iostream>
-#include <sstream>
-#include <iomanip>
-#include <ctime>
 #include <map>
 
 /**
@@ -51,9 +47,9 @@ void Decompiler::AsmCoder::writeInfo(const Pex::Binary &pex)
     write(indent(1) << ".source \"" << header.getSourceFileName() << "\"");
     if (debug.getModificationTime() != 0)
     {
-        write(indent(1) << ".modifyTime " << debug.getModificationTime() << " ;" << std::put_time(std::localtime(&debug.getModificationTime()), "%Y-%m-%d %H:%M:%S"));
+        write(indent(1) << ".modifyTime " << debug.getModificationTime() << " ;" << Pex::Format::localTime(debug.getModificationTime()));
     }
-    write(indent(1) << ".compileTime " << header.getCompilationTime() << " ;" << std::put_time(std::localtime(&header.getCompilationTime()), "%Y-%m-%d %H:%M:%S"));
+    write(indent(1) << ".compileTime " << header.getCompilationTime() << " ;" << Pex::Format::localTime(header.getCompilationTime()));
 
     write(indent(1) << ".user \"" << header.getUserName() << "\"");
     write(indent(1) << ".computer \"" << header.getComputerName() << "\"");
@@ -71,7 +67,7 @@ void Decompiler::AsmCoder::writeUserFlagsRef(const Pex::Binary &pex)
     for (auto& flag : flags)
     {
         write(indent(1) << ".flag " << flag.getName().asString() << " " << (int)flag.getFlagIndex()
-              << " ;0x" << std::setw(8) << std::setfill('0') << std::hex << std::uppercase << (1 << flag.getFlagIndex()));
+              << " ;0x" << Pex::Format::hex(1u << flag.getFlagIndex(), 8));
     }
     write(".endUserFlagsRef");
 }
@@ -110,7 +106,7 @@ void Decompiler::AsmCoder::writeVariableTable(int i, const Pex::Object &object,
     {
         write(indent(i+1) << ".variable " << var.getName().asString() << " " << var.getTypeName().asString());
         writeUserFlags(indent(i+2), var, pex);
-        write(indent(i+2) << ".initialValue " << var.getDefaultValue().toString());
+        write(indent(i+2) << ".initialValue " << var.getDefaultValue());
         write(indent(i+1) << ".endVariable");
     }
     write(indent(i) << ".endVariableTable");
@@ -314,7 +310,7 @@ void Decompiler::AsmCoder::writeCode(int i, const Pex::Instructions &instruction
             assert(ins.getArgs().size() == 2);
             assert(ins.getArgs()[1].getType() == Pex::ValueType::Integer);
 
-            stream << ins.getArgs()[0].toString() << " ";
+            stream << ins.getArgs()[0] << " ";
             auto target = ip + ins.getArgs()[1].getInteger();
 
             stream << "_label" << label[target];
@@ -325,14 +321,14 @@ void Decompiler::AsmCoder::writeCode(int i, const Pex::Instructions &instruction
         {
             for (auto& arg : ins.getArgs())
             {
-                stream << arg.toString() << " ";
+                stream << arg << " ";
             }
 
             if (ins.hasVarArgs())
             {
                 for (auto& arg : ins.getVarArgs())
                 {
-                    stream << arg.toString() << " ";
+                    stream << arg << " ";
                 }
                 stream << ";" << ins.getVarArgs().size() << " variable args";
             }
@@ -341,7 +337,7 @@ void Decompiler::AsmCoder::writeCode(int i, const Pex::Instructions &instruction
         }
 
 
-        write(stream.str());
+        write(stream);
         ++ip;
     }
     // Write the last label, if one.
@@ -352,12 +348,12 @@ void Decompiler::AsmCoder::writeCode(int i, const Pex::Instructions &instruction
 }
 
 /**
- * @brief Writes the User Flags associated with an element to a stream.
- * @param stream The stream to write.
+ * @brief Writes the User Flags associated with an element to a line.
+ * @param stream The line to write.
  * @param flagged The flagged element.
  * @param pex The source binary.
  */
-void Decompiler::AsmCoder::writeUserFlags(std::ostream&& stream, const Pex::UserFlagged &flagged, const Pex::Binary &pex)
+void Decompiler::AsmCoder::writeUserFlags(LineBuffer&& stream, const Pex::UserFlagged &flagged, const Pex::Binary &pex)
 {
     auto& flagsref = pex.getUserFlags();
 
@@ -379,6 +375,5 @@ void Decompiler::AsmCoder::writeUserFlags(std::ostream&& stream, const Pex::User
     {
         stream << "none";
     }
-    auto& sstream = static_cast<std::ostringstream&>(stream);
-    write(sstream.str());
+    write(stream);
 }
@@ -0,0 +1,574 @@
+#include "BatchReader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CHAMPOLLION_PREAD
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+// The opens, stats, reads and closes through io_uring came with Linux 5.6, as the probe of the operations
+#if defined(IO_URING_OP_SUPPORTED) && defined(STATX_SIZE) && defined(__NR_io_uring_setup)
+#define CHAMPOLLION_IO_URING
+#endif
+#endif
+
+namespace {
+
+std::string errorMessage(int error)
+{
+    return std::system_category().message(error);
+}
+
+}
+
+#ifdef CHAMPOLLION_IO_URING
+
+/**
+ * @brief Submission and completion queues of an io_uring instance, mapped in memory.
+ */
+struct Decompiler::BatchReader::Ring
+{
+    // Submission queue entries, at most two per file of a batch
+    static const unsigned ENTRIES = 64;
+
+    int fd = -1;
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    size_t sqRingSize = 0;
+    size_t cqRingSize = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqesSize = 0;
+
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned pending = 0;
+    // False if a failed submission left operations the kernel may still complete
+    bool idle = true;
+
+    bool setup();
+    ~Ring();
+
+    io_uring_sqe* next(std::uint8_t opcode, std::uint64_t userData);
+    template <typename Complete>
+    void submit(Complete complete);
+    template <typename Complete>
+    void reap(unsigned& waiting, Complete& complete);
+    template <typename Complete>
+    bool drain(unsigned inFlight, Complete& complete);
+};
+
+/**
+ * @brief Create the ring.
+ * @return False if io_uring, or one of the operations used, is not available.
+ */
+bool Decompiler::BatchReader::Ring::setup()
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    fd = static_cast<int>(syscall(__NR_io_uring_setup, ENTRIES, &params));
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single)
+    {
+        sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+    }
+    sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED)
+    {
+        return false;
+    }
+    cqRing = single ? sqRing
+                    : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (cqRing == MAP_FAILED)
+    {
+        return false;
+    }
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                           fd, IORING_OFF_SQES));
+    if (sqes == MAP_FAILED)
+    {
+        return false;
+    }
+
+    auto sq = static_cast<char*>(sqRing);
+    auto cq = static_cast<char*>(cqRing);
+    sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // Check the operations, older kernels have io_uring without them
+    const std::uint8_t operations[] = {IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_CLOSE};
+    std::vector<char> probeData(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+    auto probe = reinterpret_cast<io_uring_probe*>(probeData.data());
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) < 0)
+    {
+        return false;
+    }
+    for (auto operation : operations)
+    {
+        if (operation > probe->last_op || (probe->ops[operation].flags & IO_URING_OP_SUPPORTED) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+Decompiler::BatchReader::Ring::~Ring()
+{
+    if (sqes != MAP_FAILED)
+    {
+        munmap(sqes, sqesSize);
+    }
+    if (cqRing != MAP_FAILED && cqRing != sqRing)
+    {
+        munmap(cqRing, cqRingSize);
+    }
+    if (sqRing != MAP_FAILED)
+    {
+        munmap(sqRing, sqRingSize);
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+}
+
+/**
+ * @brief Queue an operation, submitted by the next call to submit.
+ * @param opcode Operation.
+ * @param userData Value given back with the completion.
+ * @return The entry of the operation, to fill in.
+ */
+io_uring_sqe *Decompiler::BatchReader::Ring::next(std::uint8_t opcode, std::uint64_t userData)
+{
+    // Only this thread writes the tail, the kernel reads it once submitted
+    auto tail = *sqTail;
+    auto index = tail & *sqMask;
+    auto sqe = &sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->user_data = userData;
+    sqArray[index] = index;
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+    ++pending;
+    return sqe;
+}
+
+/**
+ * @brief Submit the queued operations and wait for all of them.
+ * On failure, the operations already submitted are waited for before throwing. If they
+ * cannot be, idle is cleared: the kernel may still write to their buffers.
+ *
+ * @param complete Called with the user data and the result of each operation.
+ */
+template <typename Complete>
+void Decompiler::BatchReader::Ring::submit(Complete complete)
+{
+    auto submitting = pending;
+    auto waiting = pending;
+    pending = 0;
+    while (waiting > 0)
+    {
+        auto submitted = syscall(__NR_io_uring_enter, fd, submitting, waiting, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (submitted < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            auto error = errno;
+            // The operations never submitted will not run, the others are still in flight
+            idle = drain(waiting - submitting, complete);
+            throw std::runtime_error("io_uring_enter failed: " + errorMessage(error));
+        }
+        submitting -= static_cast<unsigned>(submitted);
+        reap(waiting, complete);
+    }
+}
+
+/**
+ * @brief Handle the completions available in the completion queue.
+ * @param[in,out] waiting Number of operations not completed yet, decreased by the completions.
+ * @param complete Called with the user data and the result of each operation.
+ */
+template <typename Complete>
+void Decompiler::BatchReader::Ring::reap(unsigned &waiting, Complete &complete)
+{
+    auto head = *cqHead;
+    auto tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head, --waiting)
+    {
+        auto& cqe = cqes[head & *cqMask];
+        complete(cqe.user_data, cqe.res);
+    }
+    __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Wait for the operations in flight, without submitting new ones.
+ * @param inFlight Number of operations submitted and not completed.
+ * @param complete Called with the user data and the result of each operation.
+ * @return False if the wait failed, some operations may then still be running.
+ */
+template <typename Complete>
+bool Decompiler::BatchReader::Ring::drain(unsigned inFlight, Complete &complete)
+{
+    reap(inFlight, complete);
+    while (inFlight > 0)
+    {
+        if (syscall(__NR_io_uring_enter, fd, 0, inFlight, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR)
+        {
+            return false;
+        }
+        reap(inFlight, complete);
+    }
+    return true;
+}
+
+#else
+
+struct Decompiler::BatchReader::Ring
+{
+};
+
+#endif
+
+/**
+ * @brief Constructor
+ * @param useIoUring True to read through io_uring when the system supports it.
+ */
+Decompiler::BatchReader::BatchReader(bool useIoUring)
+{
+#ifdef CHAMPOLLION_IO_URING
+    if (useIoUring)
+    {
+        m_Ring = std::make_unique<Ring>();
+        if (!m_Ring->setup())
+        {
+            m_Ring.reset();
+        }
+    }
+#else
+    (void)useIoUring;
+#endif
+}
+
+/**
+ * @brief Default destructor
+ */
+Decompiler::BatchReader::~BatchReader()
+{
+}
+
+/**
+ * @brief Read files.
+ * If io_uring fails, it is no longer used and the files are read with pread.
+ *
+ * @param[in,out] files Files to read, receive their content or the error.
+ */
+void Decompiler::BatchReader::read(std::vector<File> &files)
+{
+    if (m_Ring)
+    {
+        try
+        {
+            readWithIoUring(files);
+            return;
+        }
+        catch (const std::exception&)
+        {
+            // The ring is dropped, this batch and the next ones are read without it
+            for (auto& file : files)
+            {
+                file.content.clear();
+                file.error.clear();
+            }
+        }
+    }
+#ifdef CHAMPOLLION_PREAD
+    readWithPread(files);
+#else
+    readWithStreams(files);
+#endif
+}
+
+/**
+ * @brief Check if the files are read through io_uring.
+ * @return False if io_uring was not asked for or is not available, the files are then read with pread.
+ */
+bool Decompiler::BatchReader::usesIoUring() const
+{
+    return m_Ring != nullptr;
+}
+
+/**
+ * @brief Read the files with streams, on the systems without pread.
+ */
+void Decompiler::BatchReader::readWithStreams(std::vector<File> &files)
+{
+    for (auto& file : files)
+    {
+        std::ifstream stream(file.path, std::ios::binary);
+        std::ostringstream bytes;
+        if (!stream || !(bytes << stream.rdbuf()))
+        {
+            file.error = "Unable to open file";
+            continue;
+        }
+        file.content = bytes.str();
+    }
+}
+
+/**
+ * @brief Read the files with pread.
+ * All the files are opened and announced with posix_fadvise first, so the kernel reads them
+ * ahead while the first ones are copied.
+ */
+void Decompiler::BatchReader::readWithPread(std::vector<File> &files)
+{
+#ifdef CHAMPOLLION_PREAD
+    std::vector<int> fds(files.size(), -1);
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        fds[i] = open(files[i].path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fds[i] < 0)
+        {
+            files[i].error = errorMessage(errno);
+            continue;
+        }
+#ifdef POSIX_FADV_WILLNEED
+        posix_fadvise(fds[i], 0, 0, POSIX_FADV_WILLNEED);
+#endif
+    }
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        if (fds[i] < 0)
+        {
+            continue;
+        }
+        struct stat status;
+        if (fstat(fds[i], &status) != 0)
+        {
+            files[i].error = errorMessage(errno);
+        }
+        else
+        {
+            auto& content = files[i].content;
+            content.resize(static_cast<size_t>(status.st_size));
+            size_t done = 0;
+            while (done < content.size())
+            {
+                auto count = pread(fds[i], &content[done], content.size() - done, static_cast<off_t>(done));
+                if (count < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (count < 0)
+                {
+                    files[i].error = errorMessage(errno);
+                    break;
+                }
+                if (count == 0)
+                {
+                    // The file shrank since the stat
+                    content.resize(done);
+                    break;
+                }
+                done += static_cast<size_t>(count);
+            }
+        }
+        close(fds[i]);
+    }
+#else
+    readWithStreams(files);
+#endif
+}
+
+/**
+ * @brief Read the files through io_uring.
+ *
+ * The files are processed by groups of half the ring. Each group takes three submissions:
+ * the opens along with the stats giving the sizes, the reads, then the closes. The reads
+ * cut short are submitted again for the rest of the file.
+ * The kernel writes to buffers owned by the group, handed over to the files once the group
+ * is done. If a failed submission leaves operations running, the group is leaked rather
+ * than freed under them.
+ */
+void Decompiler::BatchReader::readWithIoUring(std::vector<File> &files)
+{
+#ifdef CHAMPOLLION_IO_URING
+    struct Group
+    {
+        std::vector<std::string> paths;
+        std::vector<int> fds;
+        std::vector<struct statx> stats;
+        std::vector<size_t> done;
+        std::vector<std::string> contents;
+        std::vector<std::string> errors;
+    };
+
+    const size_t groupSize = Ring::ENTRIES / 2;
+    for (size_t first = 0; first < files.size(); first += groupSize)
+    {
+        auto count = std::min(groupSize, files.size() - first);
+        auto group = std::make_unique<Group>();
+        for (size_t i = 0; i < count; ++i)
+        {
+            group->paths.push_back(files[first + i].path.string());
+        }
+        group->fds.assign(count, -1);
+        group->stats.resize(count);
+        group->done.assign(count, 0);
+        group->contents.resize(count);
+        group->errors.resize(count);
+        auto& fds = group->fds;
+        auto& stats = group->stats;
+        auto& done = group->done;
+        auto& contents = group->contents;
+        auto& errors = group->errors;
+
+        try
+        {
+            // User data: the index in the group, with the stats flagged by the high bit
+            const std::uint64_t STAT = 1ull << 63;
+            for (size_t i = 0; i < count; ++i)
+            {
+                auto open = m_Ring->next(IORING_OP_OPENAT, i);
+                open->fd = AT_FDCWD;
+                open->addr = reinterpret_cast<std::uint64_t>(group->paths[i].c_str());
+                open->open_flags = O_RDONLY | O_CLOEXEC;
+                auto stat = m_Ring->next(IORING_OP_STATX, i | STAT);
+                stat->fd = AT_FDCWD;
+                stat->addr = reinterpret_cast<std::uint64_t>(group->paths[i].c_str());
+                stat->len = STATX_SIZE;
+                stat->off = reinterpret_cast<std::uint64_t>(&stats[i]);
+            }
+            m_Ring->submit([&](std::uint64_t data, int result) {
+                auto i = static_cast<size_t>(data & ~STAT);
+                if (result < 0 && errors[i].empty())
+                {
+                    errors[i] = errorMessage(-result);
+                }
+                else if ((data & STAT) == 0)
+                {
+                    fds[i] = result;
+                }
+            });
+
+            std::vector<size_t> reading;
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (fds[i] >= 0 && errors[i].empty() && stats[i].stx_size > 0)
+                {
+                    contents[i].resize(static_cast<size_t>(stats[i].stx_size));
+                    reading.push_back(i);
+                }
+            }
+            while (!reading.empty())
+            {
+                for (auto i : reading)
+                {
+                    auto read = m_Ring->next(IORING_OP_READ, i);
+                    read->fd = fds[i];
+                    read->addr = reinterpret_cast<std::uint64_t>(&contents[i][done[i]]);
+                    read->len = static_cast<std::uint32_t>(contents[i].size() - done[i]);
+                    read->off = done[i];
+                }
+                std::vector<size_t> remaining;
+                m_Ring->submit([&](std::uint64_t data, int result) {
+                    auto i = static_cast<size_t>(data);
+                    if (result < 0)
+                    {
+                        errors[i] = errorMessage(-result);
+                    }
+                    else if (result == 0)
+                    {
+                        // The file shrank since the stat
+                        contents[i].resize(done[i]);
+                    }
+                    else
+                    {
+                        done[i] += static_cast<size_t>(result);
+                        if (done[i] < contents[i].size())
+                        {
+                            remaining.push_back(i);
+                        }
+                    }
+                });
+                reading = std::move(remaining);
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (fds[i] >= 0)
+                {
+                    // Left to the ring from now on, a descriptor is never closed twice
+                    m_Ring->next(IORING_OP_CLOSE, i)->fd = fds[i];
+                    fds[i] = -1;
+                }
+            }
+            m_Ring->submit([](std::uint64_t, int) {});
+        }
+        catch (...)
+        {
+            if (m_Ring->idle)
+            {
+                for (auto fd : fds)
+                {
+                    if (fd >= 0)
+                    {
+                        close(fd);
+                    }
+                }
+            }
+            else
+            {
+                // The kernel may still write to the buffers of the group and use its paths
+                static_cast<void>(group.release());
+            }
+            m_Ring.reset();
+            throw;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            files[first + i].content = std::move(contents[i]);
+            files[first + i].error = std::move(errors[i]);
+        }
+    }
+#else
+    readWithPread(files);
+#endif
+}
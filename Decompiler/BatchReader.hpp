@@ -0,0 +1,44 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Decompiler {
+
+/**
+ * @brief Read whole files, a batch at a time.
+ *
+ * On Linux, the opens, reads and closes of a batch are queued to io_uring and run by the
+ * kernel without a system call per file. Without io_uring, the files are read with pread,
+ * posix_fadvise telling the kernel to read each whole file ahead. On the other systems,
+ * the files are read with streams.
+ */
+class BatchReader
+{
+public:
+    struct File
+    {
+        std::filesystem::path path;
+        std::string content;
+        // Empty if the file was read
+        std::string error;
+    };
+
+    explicit BatchReader(bool useIoUring = true);
+    ~BatchReader();
+
+    void read(std::vector<File>& files);
+    bool usesIoUring() const;
+
+protected:
+    void readWithStreams(std::vector<File>& files);
+    void readWithPread(std::vector<File>& files);
+    void readWithIoUring(std::vector<File>& files);
+
+    struct Ring;
+    std::unique_ptr<Ring> m_Ring;
+};
+
+}
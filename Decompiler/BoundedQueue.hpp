@@ -0,0 +1,130 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace Decompiler {
+
+/**
+ * @brief Queue between two stages of a pipeline, shared by any number of producers and consumers.
+ *
+ * A producer waits while the queue is full, so a slow stage holds back the stages feeding it
+ * instead of letting their items pile up in memory. Once closed, the consumers drain the queue
+ * then stop.
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity);
+
+    bool push(T value);
+    bool pop(T& value);
+    bool pop(std::vector<T>& values, size_t count);
+    void close();
+
+protected:
+    std::mutex m_Mutex;
+    std::condition_variable m_NotFull;
+    std::condition_variable m_NotEmpty;
+    std::deque<T> m_Items;
+    size_t m_Capacity;
+    bool m_Closed;
+};
+
+/**
+ * @brief Constructor
+ * @param capacity Number of items the queue holds before the producers wait.
+ */
+template <typename T>
+BoundedQueue<T>::BoundedQueue(size_t capacity) :
+    m_Capacity(capacity > 0 ? capacity : 1),
+    m_Closed(false)
+{
+}
+
+/**
+ * @brief Add an item, waiting for room in the queue.
+ * @param value Item to add.
+ * @return False if the queue is closed, the item is then dropped.
+ */
+template <typename T>
+bool BoundedQueue<T>::push(T value)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_NotFull.wait(lock, [this]() { return m_Closed || m_Items.size() < m_Capacity; });
+    if (m_Closed)
+    {
+        return false;
+    }
+    m_Items.push_back(std::move(value));
+    lock.unlock();
+    m_NotEmpty.notify_one();
+    return true;
+}
+
+/**
+ * @brief Take the oldest item, waiting for one.
+ * @param[out] value Receives the item.
+ * @return False once the queue is closed and empty.
+ */
+template <typename T>
+bool BoundedQueue<T>::pop(T &value)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_NotEmpty.wait(lock, [this]() { return m_Closed || !m_Items.empty(); });
+    if (m_Items.empty())
+    {
+        return false;
+    }
+    value = std::move(m_Items.front());
+    m_Items.pop_front();
+    lock.unlock();
+    m_NotFull.notify_one();
+    return true;
+}
+
+/**
+ * @brief Take the oldest items, waiting for at least one.
+ * The items already in the queue are taken, up to count, without waiting for more.
+ * @param[out] values Receives the items, after its current content.
+ * @param count Largest number of items to take.
+ * @return False once the queue is closed and empty.
+ */
+template <typename T>
+bool BoundedQueue<T>::pop(std::vector<T> &values, size_t count)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_NotEmpty.wait(lock, [this]() { return m_Closed || !m_Items.empty(); });
+    if (m_Items.empty())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < count && !m_Items.empty(); ++i)
+    {
+        values.push_back(std::move(m_Items.front()));
+        m_Items.pop_front();
+    }
+    lock.unlock();
+    m_NotFull.notify_all();
+    return true;
+}
+
+/**
+ * @brief Tell the consumers no item will be added anymore.
+ */
+template <typename T>
+void BoundedQueue<T>::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Closed = true;
+    }
+    m_NotFull.notify_all();
+    m_NotEmpty.notify_all();
+}
+
+}
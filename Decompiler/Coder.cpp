@@ -29,33 +29,27 @@ void Decompiler::Coder::write(const std::string &line)
 {
     m_Writer->writeLine(line);
 }
-template<class T> static constexpr bool IsAnOstream = std::is_base_of<std::decay_t<T>, std::ostream>::value;
-template<class T> static constexpr bool IsAnOStringstream = std::is_base_of<std::decay_t<T>, std::ostringstream>::value;
-
 /**
- * @brief Write the content of a ostringstream.
- * The ostringstream is passed as an ostream. This is intended
- * to write output in the form
+ * @brief Write a line built from indent.
+ * This is intended to write output in the form
  *  write(indent(i) << "line data");
- * @param stream The stream as an ostream.
+ * The storage of the line is kept for the next call to indent.
+ * @param line The line to write.
  */
-void Decompiler::Coder::write(std::ostream&& stream)
+void Decompiler::Coder::write(LineBuffer& line)
 {
-    auto& sstream = static_cast<std::ostringstream&>(stream);
-    m_Writer->writeLine(sstream.str());
+    m_Writer->writeLine(line.str());
+    m_Spare = line.release();
 }
 
 /**
- * @brief Creates an ostringstream and prepare it with identation.
+ * @brief Creates a line and prepare it with identation.
  * @param i Indentation level to apply.
  * @return
  */
-std::ostringstream Decompiler::Coder::indent(int i)
+Decompiler::LineBuffer Decompiler::Coder::indent(int i)
 {
-    std::ostringstream result;
-    for(; i != 0; --i)
-    {
-        result << ' ' << ' ';
-    }
+    LineBuffer result(std::move(m_Spare));
+    result.reset(i);
     return result;
 }
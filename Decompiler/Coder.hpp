@@ -1,8 +1,9 @@
 #pragma once
 
 #include <memory>
-#include <sstream>
+#include <string>
 
+#include "LineBuffer.hpp"
 #include "OutputWriter.hpp"
 #include "Pex/Binary.hpp"
 
@@ -23,11 +24,12 @@ public:
 
 protected:
     void write(const std::string& line);
-    void write(std::ostream&& stream);
+    void write(LineBuffer& line);
 
 
-    std::ostringstream indent(int i);
+    LineBuffer indent(int i);
 
     std::unique_ptr<OutputWriter> m_Writer;
+    std::string m_Spare;
 };
 }
@@ -0,0 +1,83 @@
+#include "ContentHash.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+static std::uint64_t rotateLeft(std::uint64_t value, int count)
+{
+    return (value << count) | (value >> (64 - count));
+}
+
+/**
+ * @brief Constructor
+ */
+Decompiler::ContentHash::ContentHash() :
+    m_First(0x9E3779B97F4A7C15ull),
+    m_Second(0xC2B2AE3D27D4EB4Full),
+    m_Length(0)
+{
+}
+
+/**
+ * @brief Hash more data.
+ * The data of successive calls is hashed as separate blocks, the length of each block included,
+ * so "ab" then "c" and "a" then "bc" give different hashes.
+ *
+ * @param data Data to hash.
+ * @return This hash.
+ */
+Decompiler::ContentHash& Decompiler::ContentHash::update(std::string_view data)
+{
+    auto bytes = data.data();
+    auto size = data.size();
+    while (size >= 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, bytes, 8);
+        mix(word);
+        bytes += 8;
+        size -= 8;
+    }
+    std::uint64_t last = 0;
+    std::memcpy(&last, bytes, size);
+    mix(last ^ (static_cast<std::uint64_t>(data.size()) << 56));
+    mix(data.size());
+    m_Length += data.size();
+    return *this;
+}
+
+/**
+ * @brief Get the hash.
+ * @return The hash as 32 hexadecimal digits.
+ */
+std::string Decompiler::ContentHash::toString() const
+{
+    auto first = m_First ^ rotateLeft(m_Second, 17) ^ m_Length;
+    auto second = m_Second ^ rotateLeft(m_First, 43);
+    first *= 0xFF51AFD7ED558CCDull;
+    first ^= first >> 33;
+    second *= 0xC4CEB9FE1A85EC53ull;
+    second ^= second >> 33;
+    char text[33];
+    std::snprintf(text, sizeof(text), "%016llx%016llx", static_cast<unsigned long long>(first),
+                  static_cast<unsigned long long>(second));
+    return text;
+}
+
+/**
+ * @brief Hash a content.
+ * @param data Content to hash.
+ * @return The hash as 32 hexadecimal digits.
+ */
+std::string Decompiler::ContentHash::of(std::string_view data)
+{
+    return ContentHash().update(data).toString();
+}
+
+// The lanes are independent multiply and rotate mixers. The words are read in the byte order
+// of the machine, hashes are only compared on the machine computing them.
+void Decompiler::ContentHash::mix(std::uint64_t word)
+{
+    m_First = rotateLeft((m_First ^ word) * 0x87C37B91114253D5ull, 31);
+    m_Second = rotateLeft(m_Second + word * 0x4CF5AD432745937Full, 27) * 0x9E3779B97F4A7C15ull;
+}
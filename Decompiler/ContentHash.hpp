@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Decompiler {
+
+/**
+ * @brief 128 bits hash of a content, used as the key of the cached outputs.
+ *
+ * The content is hashed 8 bytes at a time in two independent lanes, so the hash runs
+ * at memory speed. It is not a cryptographic hash, it identifies files, it does not
+ * resist crafted collisions.
+ */
+class ContentHash
+{
+public:
+    ContentHash();
+
+    ContentHash& update(std::string_view data);
+    std::string toString() const;
+
+    static std::string of(std::string_view data);
+
+protected:
+    void mix(std::uint64_t word);
+
+    std::uint64_t m_First;
+    std::uint64_t m_Second;
+    std::uint64_t m_Length;
+};
+
+}
@@ -1,11 +1,12 @@
 #pragma once
-#include <vector>
-#include <string>
+#include <string_view>
+
+#include "StringSet.hpp"
 
 namespace Decompiler{
 	namespace Skyrim {
-        static const std::vector<std::string> NativeClasses ={};
-		static const std::vector<std::string> EventNames = {
+        inline constexpr StringSet<0> NativeClasses{};
+		inline constexpr std::string_view EventNamesList[] = {
 			"OnAnimationEvent", // ActiveMagicEffect
 			"OnAnimationEventUnregistered", // ActiveMagicEffect
 			"OnEffectFinish", // ActiveMagicEffect
@@ -117,121 +118,10 @@ namespace Decompiler{
 			"OnEndState",
 			"OnInit"
 		};
-        static const std::vector<std::string> EventNamesLowerCase = {
-			"onanimationevent", // ActiveMagicEffect
-			"onanimationeventunregistered", // ActiveMagicEffect
-			"oneffectfinish", // ActiveMagicEffect
-			"oneffectstart", // ActiveMagicEffect
-			"ongainlos", // ActiveMagicEffect
-			"onlostlos", // ActiveMagicEffect
-			"onupdate", // ActiveMagicEffect
-			"oncombatstatechanged", // Actor
-			"ondeath", // Actor
-			"ondying", // Actor
-			"onenterbleedout", // Actor
-			"ongetup", // Actor
-			"onlocationchange", // Actor
-			"onlycanthropystatechanged", // Actor
-			"onobjectequipped", // Actor
-			"onobjectunequipped", // Actor
-			"onpackagechange", // Actor
-			"onpackageend", // Actor
-			"onpackagestart", // Actor
-			"onplayerbowshot", // Actor
-			"onplayerfasttravelend", // Actor
-			"onplayerloadgame", // Actor
-			"onraceswitchcomplete", // Actor
-			"onsit", // Actor
-			"onvampirefeed", // Actor
-			"onvampirismstatechanged", // Actor
-			"onanimationevent", // Alias
-			"onanimationeventunregistered", // Alias
-			"ongainlos", // Alias
-			"onlostlos", // Alias
-			"onreset", // Alias
-			"onupdate", // Alias
-			"onanimationevent", // Form
-			"onanimationeventunregistered", // Form
-			"ongainlos", // Form
-			"onlostlos", // Form
-			"onsleepstart", // Form
-			"onsleepstop", // Form
-			"ontrackedstatsevent", // Form
-			"onupdate", // Form
-			"onupdategametime", // Form
-			"onactivate", // ObjectReference
-			"onattachedtocell", // ObjectReference
-			"oncellattach", // ObjectReference
-			"oncelldetach", // ObjectReference
-			"oncellload", // ObjectReference
-			"onclose", // ObjectReference
-			"oncontainerchanged", // ObjectReference
-			"ondestructionstagechanged", // ObjectReference
-			"ondetachedfromcell", // ObjectReference
-			"onequipped", // ObjectReference
-			"ongrab", // ObjectReference
-			"onhit", // ObjectReference
-			"onitemadded", // ObjectReference
-			"onitemremoved", // ObjectReference
-			"onload", // ObjectReference
-			"onlockstatechanged", // ObjectReference
-			"onmagiceffectapply", // ObjectReference
-			"onopen", // ObjectReference
-			"onread", // ObjectReference
-			"onrelease", // ObjectReference
-			"onreset", // ObjectReference
-			"onsell", // ObjectReference
-			"onspellcast", // ObjectReference
-			"ontranslationalmostcomplete", // ObjectReference
-			"ontranslationcomplete", // ObjectReference
-			"ontranslationfailed", // ObjectReference
-			"ontraphit", // ObjectReference
-			"ontraphitstart", // ObjectReference
-			"ontraphitstop", // ObjectReference
-			"ontrigger", // ObjectReference
-			"ontriggerenter", // ObjectReference
-			"ontriggerleave", // ObjectReference
-			"onunequipped", // ObjectReference
-			"onunload", // ObjectReference
-			"onwardhit", // ObjectReference
-			"onreset", // Quest
-			"onstoryactivateactor", // Quest
-			"onstoryaddtoplayer", // Quest
-			"onstoryarrest", // Quest
-			"onstoryassaultactor", // Quest
-			"onstorybribenpc", // Quest
-			"onstorycastmagic", // Quest
-			"onstorychangelocation", // Quest
-			"onstorycraftitem", // Quest
-			"onstorycrimegold", // Quest
-			"onstorycure", // Quest
-			"onstorydialogue", // Quest
-			"onstorydiscoverdeadbody", // Quest
-			"onstoryescapejail", // Quest
-			"onstoryflatternpc", // Quest
-			"onstoryhello", // Quest
-			"onstoryincreaselevel", // Quest
-			"onstoryincreaseskill", // Quest
-			"onstoryinfection", // Quest
-			"onstoryintimidatenpc", // Quest
-			"onstoryjail", // Quest
-			"onstorykillactor", // Quest
-			"onstorynewvoicepower", // Quest
-			"onstorypayfine", // Quest
-			"onstorypicklock", // Quest
-			"onstoryplayergetsfavor", // Quest
-			"onstoryrelationshipchange", // Quest
-			"onstoryremovefromplayer", // Quest
-			"onstoryscript", // Quest
-			"onstoryservedtime", // Quest
-			"onstorytrespass", // Quest
-			"onbeginstate",
-			"onendstate",
-			"oninit"
-		};
+		inline constexpr StringSet EventNames{EventNamesList};
 	}
 	namespace Fallout4{
-        static const std::vector<std::string> NativeClasses ={
+        inline constexpr std::string_view NativeClassesList[] = {
                 "Action",
                 "Activator",
                 "ActiveMagicEffect",
@@ -324,7 +214,8 @@ namespace Decompiler{
                 "WordOfPower",
                 "WorldSpace",
         };
-		static const std::vector<std::string> EventNames = {
+        inline constexpr StringSet NativeClasses{NativeClassesList};
+		inline constexpr std::string_view EventNamesList[] = {
 			"OnEffectFinish", // ActiveMagicEffect
 			"OnEffectStart", // ActiveMagicEffect
 			"OnCombatStateChanged", // Actor
@@ -459,145 +350,11 @@ namespace Decompiler{
 			"OnBegin", // TopicInfo
 			"OnEnd", // TopicInfo
         };
+		inline constexpr StringSet EventNames{EventNamesList};
 
-		static const std::vector<std::string> EventNamesLowerCase = {
-			"oneffectfinish", // ActiveMagicEffect
-			"oneffectstart", // ActiveMagicEffect
-			"oncombatstatechanged", // Actor
-			"oncommandmodecompletecommand", // Actor
-			"oncommandmodeenter", // Actor
-			"oncommandmodeexit", // Actor
-			"oncommandmodegivecommand", // Actor
-			"oncompaniondismiss", // Actor
-			"onconsciousnessstatechanged", // Actor
-			"oncripple", // Actor
-			"ondeath", // Actor
-			"ondeferredkill", // Actor
-			"ondifficultychanged", // Actor
-			"ondying", // Actor
-			"onenterbleedout", // Actor
-			"onentersneaking", // Actor
-			"onescortwaitstart", // Actor
-			"onescortwaitstop", // Actor
-			"ongetup", // Actor
-			"onitemequipped", // Actor
-			"onitemunequipped", // Actor
-			"onkill", // Actor
-			"onlocationchange", // Actor
-			"onpackagechange", // Actor
-			"onpackageend", // Actor
-			"onpackagestart", // Actor
-			"onpartialcripple", // Actor
-			"onpickpocketfailed", // Actor
-			"onplayercreaterobot", // Actor
-			"onplayerentervertibird", // Actor
-			"onplayerfalllongdistance", // Actor
-			"onplayerfireweapon", // Actor
-			"onplayerhealteammate", // Actor
-			"onplayerloadgame", // Actor
-			"onplayermodarmorweapon", // Actor
-			"onplayermodrobot", // Actor
-			"onplayerswimming", // Actor
-			"onplayeruseworkbench", // Actor
-			"onraceswitchcomplete", // Actor
-			"onsit", // Actor
-			"onspeechchallengeavailable", // Actor
-			"onaliasinit", // Alias
-			"onaliasreset", // Alias
-			"onaliasshutdown", // Alias
-			"onlocationcleared", // Location
-			"onlocationloaded", // Location
-			"onactivate", // ObjectReference
-			"oncellattach", // ObjectReference
-			"oncelldetach", // ObjectReference
-			"oncellload", // ObjectReference
-			"onclose", // ObjectReference
-			"oncontainerchanged", // ObjectReference
-			"ondestructionstagechanged", // ObjectReference
-			"onequipped", // ObjectReference
-			"onexitfurniture", // ObjectReference
-			"ongrab", // ObjectReference
-			"onholotapechatter", // ObjectReference
-			"onholotapeplay", // ObjectReference
-			"onitemadded", // ObjectReference
-			"onitemremoved", // ObjectReference
-			"onload", // ObjectReference
-			"onlockstatechanged", // ObjectReference
-			"onopen", // ObjectReference
-			"onpipboyradiodetection", // ObjectReference
-			"onplayerdialoguetarget", // ObjectReference
-			"onpoweroff", // ObjectReference
-			"onpoweron", // ObjectReference
-			"onread", // ObjectReference
-			"onrelease", // ObjectReference
-			"onreset", // ObjectReference
-			"onsell", // ObjectReference
-			"onspellcast", // ObjectReference
-			"ontranslationalmostcomplete", // ObjectReference
-			"ontranslationcomplete", // ObjectReference
-			"ontranslationfailed", // ObjectReference
-			"ontraphitstart", // ObjectReference
-			"ontraphitstop", // ObjectReference
-			"ontriggerenter", // ObjectReference
-			"ontriggerleave", // ObjectReference
-			"onunequipped", // ObjectReference
-			"onunload", // ObjectReference
-			"onworkshopmode", // ObjectReference
-			"onworkshopnpctransfer", // ObjectReference
-			"onworkshopobjectdestroyed", // ObjectReference
-			"onworkshopobjectgrabbed", // ObjectReference
-			"onworkshopobjectmoved", // ObjectReference
-			"onworkshopobjectplaced", // ObjectReference
-			"onworkshopobjectrepaired", // ObjectReference
-			"onchange", // Package
-			"onend", // Package
-			"onstart", // Package
-			"onentryrun", // Perk
-			"onquestinit", // Quest
-			"onquestshutdown", // Quest
-			"onstageset", // Quest
-			"onstoryincreaselevel", // Quest
-			"onaction", // Scene
-			"onbegin", // Scene
-			"onend", // Scene
-			"onphasebegin", // Scene
-			"onphaseend", // Scene
-			"onanimationevent", // ScriptObject
-			"onanimationeventunregistered", // ScriptObject
-			"onbeginstate", // ScriptObject
-			"oncontroldown", // ScriptObject
-			"oncontrolup", // ScriptObject
-			"ondistancegreaterthan", // ScriptObject
-			"ondistancelessthan", // ScriptObject
-			"onendstate", // ScriptObject
-			"onfurnitureevent", // ScriptObject
-			"ongainlos", // ScriptObject
-			"onhit", // ScriptObject
-			"oninit", // ScriptObject
-			"onkeydown", // ScriptObject
-			"onkeyup", // ScriptObject
-			"onlooksmenuevent", // ScriptObject
-			"onlostlos", // ScriptObject
-			"onmagiceffectapply", // ScriptObject
-			"onmenuopencloseevent", // ScriptObject
-			"onplayercamerastate", // ScriptObject
-			"onplayersleepstart", // ScriptObject
-			"onplayersleepstop", // ScriptObject
-			"onplayerteleport", // ScriptObject
-			"onplayerwaitstart", // ScriptObject
-			"onplayerwaitstop", // ScriptObject
-			"onradiationdamage", // ScriptObject
-			"ontimer", // ScriptObject
-			"ontimergametime", // ScriptObject
-			"ontrackedstatsevent", // ScriptObject
-			"ontutorialevent", // ScriptObject
-			"onmenuitemrun", // Terminal
-			"onbegin", // TopicInfo
-			"onend", // TopicInfo
-		};
 	}
     namespace Starfield {
-        static const std::vector<std::string> NativeClasses = {
+        inline constexpr std::string_view NativeClassesList[] = {
                 //Forms
                 "Action",
                 "Activator",
@@ -701,7 +458,8 @@ namespace Decompiler{
                 "ScriptObject",
                 "Utility",
         };
-        static const std::vector<std::string> EventNames = {
+        inline constexpr StringSet NativeClasses{NativeClassesList};
+        inline constexpr std::string_view EventNamesList[] = {
                 "OnAction",
                 "OnActivate",
                 "OnActorActivatedRef",
@@ -940,244 +698,6 @@ namespace Decompiler{
                 "OnWorkshopObjectRemoved",
                 "OnWorkshopOutputLink",
         };
-        static const std::vector<std::string> EventNamesLowerCase = {
-                "onaction",
-                "onactivate",
-                "onactoractivatedref",
-                "onactorvaluechanged",
-                "onactorvaluegreaterthan",
-                "onactorvaluelessthan",
-                "onaffinityevent",
-                "onaffinityeventsent",
-                "onaliaschanged",
-                "onaliasinit",
-                "onaliasreset",
-                "onaliasshutdown",
-                "onaliasstarted",
-                "onanimationevent",
-                "onanimationeventunregistered",
-                "onbegin",
-                "onbeginstate",
-                "onbuildermenuselect",
-                "oncellattach",
-                "oncelldetach",
-                "oncellload",
-                "onchallengecompleted",
-                "onchange",
-                "onclose",
-                "oncombatlistadded",
-                "oncombatlistremoved",
-                "oncombatstatechanged",
-                "oncommandmodecompletecommand",
-                "oncommandmodeenter",
-                "oncommandmodeexit",
-                "oncommandmodegivecommand",
-                "oncompaniondismiss",
-                "onconsciousnessstatechanged",
-                "oncontainerchanged",
-                "oncrewassigned",
-                "oncrewdismissed",
-                "oncripple",
-                "ondeath",
-                "ondeferredkill",
-                "ondestroyed",
-                "ondestructionstagechanged",
-                "ondifficultychanged",
-                "ondistancegreaterthan",
-                "ondistancelessthan",
-                "ondying",
-                "oneffectfinish",
-                "oneffectstart",
-                "onend",
-                "onendstate",
-                "onenterbleedout",
-                "onenterfurniture",
-                "onenteroutpostbeaconmode",
-                "onentershipinterior",
-                "onentersneaking",
-                "onentryrun",
-                "onequipped",
-                "onescortwaitstart",
-                "onescortwaitstop",
-                "onexitfurniture",
-                "onexitshipinterior",
-                "ongainlos",
-                "ongetup",
-                "ongrab",
-                "onhit",
-                "onhomeshipset",
-                "oninit",
-                "onitemadded",
-                "onitemequipped",
-                "onitemremoved",
-                "onitemunequipped",
-                "onkill",
-                "onload",
-                "onlocationchange",
-                "onlocationexplored",
-                "onlocationloaded",
-                "onlockstatechanged",
-                "onlostlos",
-                "onmagiceffectapply",
-                "onmapmarkerdiscovered",
-                "onmenuopencloseevent",
-                "onmissionaccepted",
-                "onobjectdestroyed",
-                "onobjectrepaired",
-                "onopen",
-                "onoutpostitempoweroff",
-                "onoutpostitempoweron",
-                "onoutpostplaced",
-                "onpackagechange",
-                "onpackageend",
-                "onpackagestart",
-                "onpartialcripple",
-                "onphasebegin",
-                "onphaseend",
-                "onpicklock",
-                "onpickpocketfailed",
-                "onpipboyradiodetection",
-                "onplanetsiteselectevent",
-                "onplayerarrested",
-                "onplayerassaultactor",
-                "onplayerbuyship",
-                "onplayercompleteresearch",
-                "onplayercraftitem",
-                "onplayercreaterobot",
-                "onplayercrimegold",
-                "onplayerdialoguetarget",
-                "onplayerentervertibird",
-                "onplayerfailedplotroute",
-                "onplayerfalllongdistance",
-                "onplayerfireweapon",
-                "onplayerfollowerwarp",
-                "onplayerhealteammate",
-                "onplayeritemadded",
-                "onplayerjail",
-                "onplayerloadgame",
-                "onplayerloiteringbegin",
-                "onplayerloiteringend",
-                "onplayermodarmorweapon",
-                "onplayermodifiedship",
-                "onplayermodrobot",
-                "onplayermurderactor",
-                "onplayerpayfine",
-                "onplayerplanetsurveycomplete",
-                "onplayerscannedobject",
-                "onplayersellship",
-                "onplayersleepstart",
-                "onplayersleepstop",
-                "onplayerswimming",
-                "onplayerteleport",
-                "onplayertrespass",
-                "onplayeruseworkbench",
-                "onplayerwaitstart",
-                "onplayerwaitstop",
-                "onpoweroff",
-                "onpoweron",
-                "onquestinit",
-                "onquestrejected",
-                "onquestshutdown",
-                "onqueststarted",
-                "onquesttimerend",
-                "onquesttimermod",
-                "onquesttimerpause",
-                "onquesttimerresume",
-                "onquesttimerstart",
-                "onquickcontaineropened",
-                "onraceswitchcomplete",
-                "onradiationdamage",
-                "onread",
-                "onrecoverfrombleedout",
-                "onrelease",
-                "onreset",
-                "onscanned",
-                "onsell",
-                "onshipbought",
-                "onshipdock",
-                "onshipfartravel",
-                "onshipgravjump",
-                "onshiplanding",
-                "onshiprampdown",
-                "onshiprefueled",
-                "onshipscan",
-                "onshipsold",
-                "onshipsystemdamaged",
-                "onshipsystempowerchange",
-                "onshipsystemrepaired",
-                "onshiptakeoff",
-                "onshipundock",
-                "onsit",
-                "onspeechchallengeavailable",
-                "onspeechchallengecompletion",
-                "onspellcast",
-                "onstageset",
-                "onstarmaptargetselectevent",
-                "onstart",
-                "onstoryactivateactor",
-                "onstoryactorattach",
-                "onstoryaddtoplayer",
-                "onstoryarrest",
-                "onstoryassaultactor",
-                "onstoryattractionobject",
-                "onstorybribenpc",
-                "onstorycastmagic",
-                "onstorychangelocation",
-                "onstorycraftitem",
-                "onstorycrimegold",
-                "onstorycure",
-                "onstorydialogue",
-                "onstorydiscoverdeadbody",
-                "onstoryescapejail",
-                "onstoryexploredlocation",
-                "onstoryflatternpc",
-                "onstoryhackterminal",
-                "onstoryhello",
-                "onstoryincreaselevel",
-                "onstoryinfection",
-                "onstoryintimidatenpc",
-                "onstoryironsights",
-                "onstoryjail",
-                "onstorykillactor",
-                "onstorylocationloaded",
-                "onstorymineexplosion",
-                "onstorynewvoicepower",
-                "onstorypayfine",
-                "onstorypicklock",
-                "onstorypickpocket",
-                "onstorypiracyactor",
-                "onstoryplayergetsfavor",
-                "onstoryrelationshipchange",
-                "onstoryremovefromplayer",
-                "onstoryscript",
-                "onstoryservedtime",
-                "onstoryshipdock",
-                "onstoryshiplanding",
-                "onstorytrespass",
-                "onterminalmenuenter",
-                "onterminalmenuitemrun",
-                "ontimer",
-                "ontimergametime",
-                "ontrackedstatsevent",
-                "ontranslationalmostcomplete",
-                "ontranslationcomplete",
-                "ontranslationfailed",
-                "ontraphitstart",
-                "ontraphitstop",
-                "ontriggerenter",
-                "ontriggerleave",
-                "ontutorialevent",
-                "onunequipped",
-                "onunload",
-                "onworkshopcargolinkchanged",
-                "onworkshopflycam",
-                "onworkshopmode",
-                "onworkshopnpctransfer",
-                "onworkshopobjectgrabbed",
-                "onworkshopobjectmoved",
-                "onworkshopobjectplaced",
-                "onworkshopobjectremoved",
-                "onworkshopoutputlink",
-        };
+        inline constexpr StringSet EventNames{EventNamesList};
     }
 }
\ No newline at end of file
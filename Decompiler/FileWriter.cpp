@@ -0,0 +1,194 @@
+#include "FileWriter.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+// Unique suffix for the temporary files. The random start keeps concurrent processes
+// apart, the counter keeps the threads of this process apart.
+static std::string temporarySuffix()
+{
+    static std::atomic<std::uint64_t> counter{(static_cast<std::uint64_t>(std::random_device{}()) << 32)};
+    char buffer[32];
+    auto value = counter.fetch_add(1);
+    auto length = std::snprintf(buffer, sizeof(buffer), ".%016llx.tmp", static_cast<unsigned long long>(value));
+    return std::string(buffer, length);
+}
+
+/**
+ * @brief Constructor
+ * Nothing is written until the writer is committed.
+ *
+ * @param path Path of the destination file.
+ */
+Decompiler::FileWriter::FileWriter(std::string path) :
+    m_Path(std::move(path)),
+    m_SkipUnchanged(false),
+    m_Binary(false)
+{
+    m_Buffer.reserve(64 * 1024);
+}
+
+/**
+ * @brief Append a line to the file buffer.
+ * @param line Line to write, without the line break.
+ */
+void Decompiler::FileWriter::writeLine(const std::string &line)
+{
+    m_Buffer.append(line);
+    m_Buffer.push_back('\n');
+}
+
+/**
+ * @brief Append already formatted content to the file buffer.
+ * @param content Content to write, with its line breaks.
+ */
+void Decompiler::FileWriter::writeContent(const std::string &content)
+{
+    m_Buffer.append(content);
+}
+
+/**
+ * @brief Set the option to leave the destination untouched when its content is the same.
+ * @param value True to compare the content with the destination before writing.
+ */
+void Decompiler::FileWriter::setSkipUnchanged(bool value)
+{
+    m_SkipUnchanged = value;
+}
+
+/**
+ * @brief Set the option to write the content as is, without translating the line breaks.
+ * @param value True to write in binary mode.
+ */
+void Decompiler::FileWriter::setBinary(bool value)
+{
+    m_Binary = value;
+}
+
+/**
+ * @brief Write the buffered content to the destination file.
+ *
+ * The content is written to a temporary file in the destination directory, which is
+ * then renamed over the destination. The parent directory is created if needed.
+ * On failure, the temporary file is removed and the destination is left untouched.
+ *
+ * @return True if the file was written, false if it was skipped because unchanged.
+ */
+bool Decompiler::FileWriter::commit()
+{
+    if (m_SkipUnchanged && isUnchanged())
+    {
+        return false;
+    }
+
+    fs::path path(m_Path);
+    if (path.has_parent_path())
+    {
+        createDirectories(path.parent_path().string());
+    }
+
+    auto temporary = m_Path + temporarySuffix();
+    {
+        // Text mode by default, to keep the platform line breaks.
+        std::ofstream stream(temporary, m_Binary ? std::ios::out | std::ios::binary : std::ios::out);
+        if (stream.fail())
+        {
+            throw std::runtime_error("Failed to open " + m_Path + " for writing");
+        }
+        stream.write(m_Buffer.data(), static_cast<std::streamsize>(m_Buffer.size()));
+        stream.close();
+        if (stream.fail())
+        {
+            std::error_code ignored;
+            fs::remove(temporary, ignored);
+            throw std::runtime_error("Failed to write " + m_Path);
+        }
+    }
+
+    std::error_code error;
+    fs::rename(temporary, path, error);
+    if (error)
+    {
+        std::error_code ignored;
+        fs::remove(temporary, ignored);
+        throw std::runtime_error("Failed to write " + m_Path + " : " + error.message());
+    }
+    return true;
+}
+
+/**
+ * @brief Compare the buffered content with the destination file.
+ * The destination is read by chunks, the comparison stops at the first difference.
+ *
+ * @return True if the destination exists and holds the buffered content.
+ */
+bool Decompiler::FileWriter::isUnchanged() const
+{
+    // Same mode as the content is written.
+    std::ifstream stream(m_Path, m_Binary ? std::ios::in | std::ios::binary : std::ios::in);
+    if (!stream)
+    {
+        return false;
+    }
+    char chunk[64 * 1024];
+    size_t offset = 0;
+    while (stream)
+    {
+        stream.read(chunk, sizeof(chunk));
+        auto count = static_cast<size_t>(stream.gcount());
+        if (count > m_Buffer.size() - offset || std::memcmp(chunk, m_Buffer.data() + offset, count) != 0)
+        {
+            return false;
+        }
+        offset += count;
+    }
+    return !stream.bad() && offset == m_Buffer.size();
+}
+
+/**
+ * @brief Get the path of the destination file.
+ * @return The path given to the constructor.
+ */
+const std::string &Decompiler::FileWriter::getPath() const
+{
+    return m_Path;
+}
+
+/**
+ * @brief Get the content written so far.
+ * @return The buffered content.
+ */
+const std::string &Decompiler::FileWriter::getContent() const
+{
+    return m_Buffer;
+}
+
+/**
+ * @brief Create a directory and its parents.
+ * The directories already created by the process are remembered, so the file system
+ * is only queried once per output directory.
+ *
+ * @param dir Directory to create.
+ */
+void Decompiler::FileWriter::createDirectories(const std::string &dir)
+{
+    static std::mutex mutex;
+    static std::set<std::string> created;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (created.count(dir) == 0)
+    {
+        fs::create_directories(dir);
+        created.insert(dir);
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+
+#include "OutputWriter.hpp"
+
+namespace Decompiler {
+
+/**
+ * @brief Output writer accumulating a whole file in memory.
+ *
+ * The lines are appended to a single buffer, written in one block to a temporary
+ * file next to the destination when the writer is committed, then renamed over the
+ * destination. A writer destroyed without commit leaves the destination untouched,
+ * so failed, concurrent or interrupted runs never leave half-written files.
+ * Optionally, a destination already holding the same content is not rewritten, which
+ * keeps its modification time.
+ * The file is written in text mode, keeping the platform line breaks, unless set to binary.
+ */
+class FileWriter : public OutputWriter
+{
+public:
+    FileWriter(std::string path);
+    virtual ~FileWriter() = default;
+
+    virtual void writeLine(const std::string& line);
+    void writeContent(const std::string& content);
+
+    void setSkipUnchanged(bool value);
+    void setBinary(bool value);
+    bool commit();
+    const std::string& getPath() const;
+    const std::string& getContent() const;
+
+    static void createDirectories(const std::string& dir);
+
+protected:
+    bool isUnchanged() const;
+
+    std::string m_Path;
+    std::string m_Buffer;
+    bool m_SkipUnchanged;
+    bool m_Binary;
+};
+
+}
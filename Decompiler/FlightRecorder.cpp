@@ -0,0 +1,117 @@
+#include "FlightRecorder.hpp"
+
+#include <iomanip>
+
+static const char* eventName(Decompiler::FlightRecorder::Event event)
+{
+    switch (event)
+    {
+    case Decompiler::FlightRecorder::Event::Pass:    return "pass";
+    case Decompiler::FlightRecorder::Event::Split:   return "split";
+    case Decompiler::FlightRecorder::Event::Boolean: return "boolean";
+    case Decompiler::FlightRecorder::Event::And:     return "and";
+    case Decompiler::FlightRecorder::Event::Or:      return "or";
+    case Decompiler::FlightRecorder::Event::Flow:    return "flow";
+    case Decompiler::FlightRecorder::Event::While:   return "while";
+    case Decompiler::FlightRecorder::Event::If:      return "if";
+    case Decompiler::FlightRecorder::Event::IfElse:  return "ifelse";
+    }
+    return "?";
+}
+
+/**
+ * @brief Constructor
+ */
+Decompiler::FlightRecorder::FlightRecorder() :
+    m_Count(0)
+{
+}
+
+/**
+ * @brief Start recording the decompilation of a function.
+ * The events of the previous function are discarded.
+ *
+ * @param function Name of the function, used when dumping the events.
+ */
+void Decompiler::FlightRecorder::start(std::string function)
+{
+    m_Count = 0;
+    m_Function = std::move(function);
+    m_Start = std::chrono::steady_clock::now();
+}
+
+/**
+ * @brief Stop recording once the function is decompiled.
+ */
+void Decompiler::FlightRecorder::stop()
+{
+    m_Function.clear();
+}
+
+/**
+ * @brief Check if a function is being decompiled.
+ * @return True if start was called without a matching stop.
+ */
+bool Decompiler::FlightRecorder::isRecording() const
+{
+    return !m_Function.empty();
+}
+
+/**
+ * @brief Get the name of the recorded function.
+ * @return The name given to start.
+ */
+const std::string &Decompiler::FlightRecorder::getFunction() const
+{
+    return m_Function;
+}
+
+/**
+ * @brief Get the time spent since the recording started.
+ * @return The elapsed time.
+ */
+std::chrono::steady_clock::duration Decompiler::FlightRecorder::elapsed() const
+{
+    return std::chrono::steady_clock::now() - m_Start;
+}
+
+/**
+ * @brief Record an event.
+ * When the buffer is full, the oldest event is overwritten.
+ *
+ * @param event Kind of event.
+ * @param label Static description of the event. The pointer is stored as is.
+ * @param first First operand, usually a block or an instruction indice.
+ * @param second Second operand.
+ */
+void Decompiler::FlightRecorder::record(Event event, const char *label, size_t first, size_t second)
+{
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed()).count();
+    m_Records[m_Count % CAPACITY] = Record{static_cast<std::uint32_t>(us), event, label,
+                                           static_cast<std::uint32_t>(first), static_cast<std::uint32_t>(second)};
+    ++m_Count;
+}
+
+/**
+ * @brief Write the recorded events, oldest first.
+ * @param stream Stream receiving the events.
+ */
+void Decompiler::FlightRecorder::dump(std::ostream &stream) const
+{
+    auto first = m_Count > CAPACITY ? m_Count - CAPACITY : 0;
+    if (first > 0)
+    {
+        stream << "... " << first << " earlier events dropped\n";
+    }
+    for (auto i = first; i < m_Count; ++i)
+    {
+        auto& record = m_Records[i % CAPACITY];
+        stream << "[" << std::setw(8) << std::setfill(' ') << record.elapsed << "us] "
+               << eventName(record.event);
+        if (record.label)
+        {
+            stream << " " << record.label;
+        }
+        stream << " " << record.first << " " << record.second << '\n';
+    }
+}
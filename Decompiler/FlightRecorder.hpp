@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace Decompiler {
+
+/**
+ * @brief Always-on, low overhead record of the decompilation of a function.
+ *
+ * The recorder keeps the last CAPACITY events of the function being decompiled
+ * in a fixed ring buffer. Recording does not allocate; the events are only
+ * formatted when the recorder is dumped, after a failure or a slow function.
+ */
+class FlightRecorder
+{
+public:
+    enum class Event : std::uint8_t
+    {
+        /// Start of a decompilation pass
+        Pass,
+        /// A block is split at an instruction
+        Split,
+        /// Entering the boolean operator detection for a block range
+        Boolean,
+        /// A "and" operator has been rebuilt
+        And,
+        /// A "or" operator has been rebuilt
+        Or,
+        /// Entering the control flow detection for a block range
+        Flow,
+        /// A while statement has been rebuilt
+        While,
+        /// An if statement has been rebuilt
+        If,
+        /// An if-else statement has been rebuilt
+        IfElse
+    };
+
+    static const size_t CAPACITY = 256;
+
+    FlightRecorder();
+
+    void start(std::string function);
+    void stop();
+    bool isRecording() const;
+    const std::string& getFunction() const;
+    std::chrono::steady_clock::duration elapsed() const;
+
+    void record(Event event, const char* label, size_t first = 0, size_t second = 0);
+    void dump(std::ostream& stream) const;
+
+protected:
+    struct Record
+    {
+        std::uint32_t elapsed;
+        Event event;
+        const char* label;
+        std::uint32_t first;
+        std::uint32_t second;
+    };
+
+    std::array<Record, CAPACITY> m_Records;
+    size_t m_Count;
+    std::string m_Function;
+    std::chrono::steady_clock::time_point m_Start;
+};
+
+}
@@ -0,0 +1,392 @@
+#include "FunctionCache.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include "ContentHash.hpp"
+#include "FileWriter.hpp"
+#include "Version.hpp"
+
+// Header of the cache file, followed by the version as the entries depend on it.
+static const char CACHE_MAGIC[] = "CHAMPOLLION FUNCTIONS 1";
+
+namespace {
+
+void appendString(std::string& data, const std::string& value)
+{
+    data.append(value);
+    data.push_back('\0');
+}
+
+template<typename T>
+void appendRaw(std::string& data, T value)
+{
+    data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendValue(std::string& data, const Pex::Value& value, const Decompiler::SymbolTable& symbols)
+{
+    data.push_back(static_cast<char>(value.getType()));
+    switch (value.getType())
+    {
+    case Pex::ValueType::Identifier:
+    {
+        auto id = value.getId();
+        appendString(data, id.isValid() ? id.asString() : std::string());
+        auto& type = symbols.typeOf(id);
+        appendString(data, type.isValid() ? type.asString() : std::string());
+        break;
+    }
+    case Pex::ValueType::String:
+        appendString(data, value.getString().isValid() ? value.getString().asString() : std::string());
+        break;
+    case Pex::ValueType::Integer:
+        appendRaw(data, value.getInteger());
+        break;
+    case Pex::ValueType::Float:
+        appendRaw(data, value.getFloat());
+        break;
+    case Pex::ValueType::Bool:
+        data.push_back(value.getBool() ? 1 : 0);
+        break;
+    default:
+        break;
+    }
+}
+
+// Binary reader of the cache file, any read past the end marks the stream as failed.
+class Reader
+{
+public:
+    explicit Reader(std::istream& stream) : m_Stream(stream), m_Size(0)
+    {
+        m_Stream.seekg(0, std::ios::end);
+        auto end = m_Stream.tellg();
+        m_Size = end < 0 ? 0 : static_cast<std::uint64_t>(end);
+        m_Stream.seekg(0, std::ios::beg);
+    }
+
+    template<typename T>
+    T read()
+    {
+        T value{};
+        m_Stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+        return value;
+    }
+
+    std::string readString()
+    {
+        auto size = read<std::uint32_t>();
+        std::string value;
+        auto position = m_Stream.tellg();
+        if (m_Stream && size <= (1u << 24) && position >= 0 && size <= m_Size - static_cast<std::uint64_t>(position))
+        {
+            value.resize(size);
+            m_Stream.read(value.data(), size);
+        }
+        else
+        {
+            m_Stream.setstate(std::ios::failbit);
+        }
+        return value;
+    }
+
+    // Number of items of a list, each at least itemSize bytes, bounded by the rest of the file
+    std::uint32_t readCount(std::uint64_t itemSize)
+    {
+        auto count = read<std::uint32_t>();
+        auto position = m_Stream.tellg();
+        if (!m_Stream || position < 0 || count * itemSize > m_Size - static_cast<std::uint64_t>(position))
+        {
+            m_Stream.setstate(std::ios::failbit);
+            return 0;
+        }
+        return count;
+    }
+
+    explicit operator bool() const
+    {
+        return static_cast<bool>(m_Stream);
+    }
+
+protected:
+    std::istream& m_Stream;
+    std::uint64_t m_Size;
+};
+
+}
+
+/**
+ * @brief Constructor
+ * @param maxBytes Size of the entries beyond which the new functions are no longer stored.
+ */
+Decompiler::FunctionCache::FunctionCache(size_t maxBytes) :
+    m_Bytes(0),
+    m_MaxBytes(maxBytes),
+    m_Modified(false),
+    m_Hits(0),
+    m_Misses(0)
+{
+}
+
+/**
+ * @brief Compute the key of a function.
+ *
+ * @param function Function to decompile.
+ * @param debugInfo Debug info of the function, null if none.
+ * @param symbols Symbols of the object, set to the function.
+ * @param commentAsm True if the assembly is written in comments.
+ * @param disabledPasses Mask of the disabled decompilation passes.
+ * @param[out] baseLine Receives the first debug line of the function, the lines of the entry are relative to it.
+ * @return The key of the function.
+ */
+std::string Decompiler::FunctionCache::makeKey(const Pex::Function &function,
+                                               const Pex::DebugInfo::FunctionInfo *debugInfo,
+                                               const SymbolTable &symbols, bool commentAsm,
+                                               std::uint32_t disabledPasses, std::uint16_t &baseLine)
+{
+    std::string data;
+    data.reserve(64 + function.getInstructions().size() * 32);
+    appendString(data, CHAMPOLLION_VERSION_STRING);
+    data.push_back(commentAsm ? 1 : 0);
+    appendRaw(data, disabledPasses);
+
+    appendString(data, function.getReturnTypeName().asString());
+    appendRaw(data, function.getFlags());
+    appendRaw(data, static_cast<std::uint32_t>(function.getParams().size()));
+    for (auto& param : function.getParams())
+    {
+        appendString(data, param.getName().asString());
+        appendString(data, param.getTypeName().asString());
+    }
+    appendRaw(data, static_cast<std::uint32_t>(function.getLocals().size()));
+    for (auto& local : function.getLocals())
+    {
+        appendString(data, local.getName().asString());
+        appendString(data, local.getTypeName().asString());
+    }
+
+    appendRaw(data, static_cast<std::uint32_t>(function.getInstructions().size()));
+    for (auto& instruction : function.getInstructions())
+    {
+        data.push_back(static_cast<char>(instruction.getOpCode()));
+        appendRaw(data, static_cast<std::uint32_t>(instruction.getArgs().size()));
+        for (auto& arg : instruction.getArgs())
+        {
+            appendValue(data, arg, symbols);
+        }
+        appendRaw(data, static_cast<std::uint32_t>(instruction.getVarArgs().size()));
+        for (auto& arg : instruction.getVarArgs())
+        {
+            appendValue(data, arg, symbols);
+        }
+    }
+
+    // The lowest line is the base, the offsets never wrap around
+    baseLine = 0;
+    data.push_back(debugInfo ? 1 : 0);
+    if (debugInfo)
+    {
+        auto& lines = debugInfo->getLineNumbers();
+        if (!lines.empty())
+        {
+            baseLine = *std::min_element(lines.begin(), lines.end());
+        }
+        appendRaw(data, static_cast<std::uint32_t>(lines.size()));
+        for (auto line : lines)
+        {
+            appendRaw(data, static_cast<std::uint16_t>(line - baseLine));
+        }
+    }
+    return ContentHash::of(data);
+}
+
+/**
+ * @brief Find the decompiled body of a function.
+ * @param key Key of the function.
+ * @param baseLine First debug line of the function.
+ * @param[out] entry Receives the lines and the line map of the function.
+ * @return True if the function was found.
+ */
+bool Decompiler::FunctionCache::find(const std::string &key, std::uint16_t baseLine, Entry &entry)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto it = m_Entries.find(key);
+        if (it == m_Entries.end())
+        {
+            ++m_Misses;
+            return false;
+        }
+        entry = it->second;
+    }
+    ++m_Hits;
+    entry.lineMap.shift(baseLine);
+    return true;
+}
+
+/**
+ * @brief Store the decompiled body of a function.
+ * Nothing is stored once the cache is full.
+ *
+ * @param key Key of the function.
+ * @param baseLine First debug line of the function.
+ * @param entry Lines and line map of the function.
+ */
+void Decompiler::FunctionCache::insert(const std::string &key, std::uint16_t baseLine, const Entry &entry)
+{
+    auto size = sizeOf(entry);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Bytes + size > m_MaxBytes || m_Entries.count(key))
+    {
+        return;
+    }
+    auto& stored = m_Entries[key];
+    stored = entry;
+    stored.lineMap.shift(-static_cast<std::int32_t>(baseLine));
+    m_Bytes += size;
+    m_Modified = true;
+}
+
+/**
+ * @brief Read the entries saved by a previous run.
+ * A missing, truncated or outdated file is ignored. A corrupt file is read up to the first
+ * inconsistent size or line map, the entries before it are kept.
+ *
+ * @param path Path of the cache file.
+ */
+void Decompiler::FunctionCache::load(const std::string &path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+    {
+        return;
+    }
+    Reader reader(stream);
+    if (reader.readString() != CACHE_MAGIC || reader.readString() != CHAMPOLLION_VERSION_STRING)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    // Each entry holds at least its key and three counts
+    auto count = reader.readCount(4 * sizeof(std::uint32_t));
+    for (std::uint32_t i = 0; reader && i < count; ++i)
+    {
+        auto key = reader.readString();
+        Entry entry;
+        entry.lines.resize(reader.readCount(sizeof(std::uint32_t)));
+        for (auto& line : entry.lines)
+        {
+            line = reader.readString();
+        }
+        entry.lineMap.m_Lines.resize(reader.readCount(sizeof(std::uint16_t)));
+        for (auto& line : entry.lineMap.m_Lines)
+        {
+            line = reader.read<std::uint16_t>();
+        }
+        entry.lineMap.m_Offsets.resize(reader.readCount(sizeof(std::uint32_t)));
+        for (auto& offset : entry.lineMap.m_Offsets)
+        {
+            offset = reader.read<std::uint32_t>();
+        }
+        // The offsets are positions in the lines, the map is read back without checks
+        auto& offsets = entry.lineMap.m_Offsets;
+        if (offsets.empty() || offsets.front() != 0 || !std::is_sorted(offsets.begin(), offsets.end())
+            || offsets.back() > entry.lineMap.m_Lines.size())
+        {
+            break;
+        }
+        auto size = sizeOf(entry);
+        if (!reader || m_Bytes + size > m_MaxBytes)
+        {
+            break;
+        }
+        m_Bytes += size;
+        m_Entries.emplace(std::move(key), std::move(entry));
+    }
+}
+
+/**
+ * @brief Write the entries to a file.
+ * The file is written to a temporary file unique to the run then renamed over the
+ * destination, concurrent runs never read a partial file.
+ *
+ * @param path Path of the cache file.
+ */
+void Decompiler::FunctionCache::save(const std::string &path) const
+{
+    std::string data;
+    auto appendBlock = [&data](const std::string& value) {
+        appendRaw(data, static_cast<std::uint32_t>(value.size()));
+        data.append(value);
+    };
+    appendBlock(CACHE_MAGIC);
+    appendBlock(CHAMPOLLION_VERSION_STRING);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    appendRaw(data, static_cast<std::uint32_t>(m_Entries.size()));
+    for (auto& entry : m_Entries)
+    {
+        appendBlock(entry.first);
+        appendRaw(data, static_cast<std::uint32_t>(entry.second.lines.size()));
+        for (auto& line : entry.second.lines)
+        {
+            appendBlock(line);
+        }
+        appendRaw(data, static_cast<std::uint32_t>(entry.second.lineMap.m_Lines.size()));
+        for (auto line : entry.second.lineMap.m_Lines)
+        {
+            appendRaw(data, line);
+        }
+        appendRaw(data, static_cast<std::uint32_t>(entry.second.lineMap.m_Offsets.size()));
+        for (auto offset : entry.second.lineMap.m_Offsets)
+        {
+            appendRaw(data, offset);
+        }
+    }
+
+    FileWriter writer(path);
+    writer.setBinary(true);
+    writer.writeContent(data);
+    writer.commit();
+}
+
+/**
+ * @brief Check if functions were added since the cache was loaded.
+ * @return True if the cache should be saved.
+ */
+bool Decompiler::FunctionCache::isModified() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Modified;
+}
+
+/**
+ * @brief Get the number of functions found in the cache.
+ * @return The number of successful calls to find.
+ */
+std::uint64_t Decompiler::FunctionCache::getHits() const
+{
+    return m_Hits;
+}
+
+/**
+ * @brief Get the number of functions not found in the cache.
+ * @return The number of failed calls to find.
+ */
+std::uint64_t Decompiler::FunctionCache::getMisses() const
+{
+    return m_Misses;
+}
+
+// Approximate memory used by an entry.
+size_t Decompiler::FunctionCache::sizeOf(const Entry &entry)
+{
+    size_t size = 128 + entry.lineMap.m_Lines.size() * 2 + entry.lineMap.m_Offsets.size() * 4;
+    for (auto& line : entry.lines)
+    {
+        size += sizeof(std::string) + line.size();
+    }
+    return size;
+}
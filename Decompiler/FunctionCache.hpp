@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Pex/DebugInfo.hpp"
+#include "Pex/Function.hpp"
+#include "PscDecompiler.hpp"
+#include "SymbolTable.hpp"
+
+namespace Decompiler {
+
+/**
+ * @brief Decompiled bodies of the functions, shared by the functions with the same code.
+ *
+ * The key of a function hashes its code with the string indices replaced by the strings,
+ * so identical functions of different scripts share their entry. The key also covers
+ * the types of the object variables used by the function, the options changing the
+ * decompiled lines and the debug line numbers relative to the first line of the
+ * function. The lines are stored relative to this first line and rebased when found.
+ *
+ * The cache is shared by the threads of the process, and can be saved to disk to be
+ * reused by the next runs.
+ */
+class FunctionCache
+{
+public:
+    struct Entry
+    {
+        std::vector<std::string> lines;
+        PscDecompiler::DebugLineMap lineMap;
+    };
+
+    explicit FunctionCache(size_t maxBytes = 256 * 1024 * 1024);
+
+    static std::string makeKey(const Pex::Function& function, const Pex::DebugInfo::FunctionInfo* debugInfo,
+                               const SymbolTable& symbols, bool commentAsm, std::uint32_t disabledPasses,
+                               std::uint16_t& baseLine);
+
+    bool find(const std::string& key, std::uint16_t baseLine, Entry& entry);
+    void insert(const std::string& key, std::uint16_t baseLine, const Entry& entry);
+
+    void load(const std::string& path);
+    void save(const std::string& path) const;
+
+    bool isModified() const;
+    std::uint64_t getHits() const;
+    std::uint64_t getMisses() const;
+
+protected:
+    static size_t sizeOf(const Entry& entry);
+
+    mutable std::mutex m_Mutex;
+    std::unordered_map<std::string, Entry> m_Entries;
+    size_t m_Bytes;
+    size_t m_MaxBytes;
+    bool m_Modified;
+    std::atomic<std::uint64_t> m_Hits;
+    std::atomic<std::uint64_t> m_Misses;
+};
+
+}
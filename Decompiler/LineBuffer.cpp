@@ -0,0 +1,113 @@
+#include "LineBuffer.hpp"
+
+/**
+ * @brief Constructor
+ * Builds a line reusing the storage of a previous line.
+ *
+ * @param storage Storage of the line. The content is discarded, the capacity is kept.
+ */
+Decompiler::LineBuffer::LineBuffer(std::string &&storage) :
+    m_Line(std::move(storage))
+{
+    m_Line.clear();
+}
+
+/**
+ * @brief Append text to the line.
+ * @param text Text to append.
+ * @return A reference to this.
+ */
+Decompiler::LineBuffer &Decompiler::LineBuffer::operator <<(std::string_view text)
+{
+    m_Line.append(text);
+    return *this;
+}
+
+/**
+ * @brief Append a character to the line.
+ * @param c Character to append.
+ * @return A reference to this.
+ */
+Decompiler::LineBuffer &Decompiler::LineBuffer::operator <<(char c)
+{
+    m_Line.push_back(c);
+    return *this;
+}
+
+/**
+ * @brief Append the string of an index to the line.
+ * @param index Index of the string to append.
+ * @return A reference to this.
+ */
+Decompiler::LineBuffer &Decompiler::LineBuffer::operator <<(const Pex::StringTable::Index &index)
+{
+    if (index.isValid())
+    {
+        m_Line.append(index.asString());
+    }
+    else
+    {
+        m_Line.append("*invalid*");
+    }
+    return *this;
+}
+
+/**
+ * @brief Append a value as a Papyrus literal to the line.
+ * @param value Value to append.
+ * @return A reference to this.
+ */
+Decompiler::LineBuffer &Decompiler::LineBuffer::operator <<(const Pex::Value &value)
+{
+    value.appendTo(m_Line);
+    return *this;
+}
+
+/**
+ * @brief Append an hexadecimal integer to the line.
+ * @param value Value to append.
+ * @return A reference to this.
+ */
+Decompiler::LineBuffer &Decompiler::LineBuffer::operator <<(const Pex::Format::Hex &value)
+{
+    Pex::Format::appendHex(m_Line, value);
+    return *this;
+}
+
+/**
+ * @brief Append a local time to the line.
+ * @param time Time to append.
+ * @return A reference to this.
+ */
+Decompiler::LineBuffer &Decompiler::LineBuffer::operator <<(const Pex::Format::LocalTime &time)
+{
+    Pex::Format::appendTime(m_Line, time);
+    return *this;
+}
+
+/**
+ * @brief Start a new line.
+ * @param level Indentation level of the line.
+ */
+void Decompiler::LineBuffer::reset(int level)
+{
+    m_Line.assign(static_cast<size_t>(level) * 2, ' ');
+}
+
+/**
+ * @brief Get the content of the line.
+ * @return The line.
+ */
+const std::string &Decompiler::LineBuffer::str() const
+{
+    return m_Line;
+}
+
+/**
+ * @brief Give away the storage of the line, to be reused by another line.
+ * @return The storage, with the content of the line.
+ */
+std::string Decompiler::LineBuffer::release()
+{
+    return std::move(m_Line);
+}
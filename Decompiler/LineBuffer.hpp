@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "Pex/Format.hpp"
+#include "Pex/StringTable.hpp"
+#include "Pex/Value.hpp"
+
+namespace Decompiler
+{
+
+/**
+ * @brief Line of text under construction.
+ *
+ * The text is appended in place to a buffer reused from one line to the next.
+ * The numbers and values are formatted directly in the buffer, without streams.
+ */
+class LineBuffer
+{
+public:
+    LineBuffer() = default;
+    explicit LineBuffer(std::string&& storage);
+
+    LineBuffer& operator << (std::string_view text);
+    LineBuffer& operator << (char c);
+    LineBuffer& operator << (const Pex::StringTable::Index& index);
+    LineBuffer& operator << (const Pex::Value& value);
+    LineBuffer& operator << (const Pex::Format::Hex& value);
+    LineBuffer& operator << (const Pex::Format::LocalTime& time);
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>>>
+    LineBuffer& operator << (T value)
+    {
+        Pex::Format::appendInteger(m_Line, value);
+        return *this;
+    }
+
+    template <typename T>
+    LineBuffer& operator << (const Pex::Format::Padded<T>& value)
+    {
+        Pex::Format::appendPadded(m_Line, value);
+        return *this;
+    }
+
+    void reset(int level);
+    const std::string& str() const;
+    std::string release();
+
+protected:
+    std::string m_Line;
+};
+
+}
@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <typeinfo>
 
 #include "Base.hpp"
 #include "FieldNodeMixin.hpp"
@@ -30,6 +31,13 @@ public:
 
     const Pex::StringTable::Index& getType() const { return m_Type; }
 
+protected:
+    size_t computeHash() const override
+    {
+        // A StructCreate is compared as an ArrayCreate, on the type only.
+        return combineHash(typeid(ArrayCreate).hash_code(), hashIndex(m_Type));
+    }
+
 private:
     const Pex::StringTable::Index& m_Type;
 };
@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <string>
 
 #include "Base.hpp"
@@ -33,6 +34,12 @@ public:
 
     const std::string& getOperator() const { return m_Operator; }
 
+protected:
+    size_t computeHash() const override
+    {
+        return combineHash(Base::computeHash(), std::hash<std::string>()(m_Operator));
+    }
+
 private:
     std::string m_Operator;
 };
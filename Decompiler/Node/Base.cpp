@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <cassert>
+#include <functional>
+#include <typeinfo>
 
 Node::Base::Base(size_t childs, size_t ip, uint8_t precedence, const Pex::StringTable::Index &result) :
     std::deque<BasePtr>(childs),
@@ -42,6 +44,7 @@ Node::Base &Node::Base::operator <<(Node::BasePtr child)
 
     push_back(child);
     child->m_Parent = this;
+    invalidateHash();
     return *this;
 }
 
@@ -64,6 +67,7 @@ void Node::Base::setChild(size_t c, Node::BasePtr child)
     {
         operator[](c) = child;
     }
+    invalidateHash();
 }
 
 void Node::Base::mergeChildren(Node::BasePtr source)
@@ -74,6 +78,8 @@ void Node::Base::mergeChildren(Node::BasePtr source)
         child->m_Parent = this;
     }
     source->clear();
+    source->invalidateHash();
+    invalidateHash();
 }
 
 Node::BasePtr Node::Base::getParent() const
@@ -95,6 +101,7 @@ void Node::Base::removeChild(Node::BasePtr child)
             *it = nullptr;
         else
             erase(it);
+        invalidateHash();
     }
 }
 
@@ -110,6 +117,7 @@ void Node::Base::replaceChild(Node::BasePtr child, Node::BasePtr newChild)
     child->m_Parent = nullptr;
     newChild->m_Parent = this;
     *childPosition = newChild;
+    invalidateHash();
 }
 
 void Node::Base::computeInstructionBounds()
@@ -142,3 +150,67 @@ void Node::Base::includeInstruction(size_t ip)
     else if (ip > m_End)
         m_End = ip;
 }
+
+/**
+ * @brief Get the structural hash of the tree.
+ * Trees considered the same by isSameTree have the same hash. The hash is computed
+ * on first use and kept until the node or one of its descendants is modified.
+ *
+ * @return The hash of the tree.
+ */
+size_t Node::Base::getHash() const
+{
+    if (!m_HashValid)
+    {
+        m_Hash = computeHash();
+        m_HashValid = true;
+    }
+    return m_Hash;
+}
+
+/**
+ * @brief Discard the hash of the node and of its ancestors.
+ * Called whenever the children of the node change.
+ */
+void Node::Base::invalidateHash()
+{
+    // A valid hash implies valid hashes in the whole subtree,
+    // so the walk stops at the first ancestor already invalidated.
+    m_HashValid = false;
+    for (auto node = m_Parent; node && node->m_HashValid; node = node->m_Parent)
+    {
+        node->m_HashValid = false;
+    }
+}
+
+/**
+ * @brief Compute the structural hash of the tree.
+ * The default hash combines the type of the node and the hashes of the children.
+ * The nodes with attributes compared by isSameTree override it to add them.
+ *
+ * @return The hash of the tree.
+ */
+size_t Node::Base::computeHash() const
+{
+    return hashChildren(typeid(*this).hash_code());
+}
+
+size_t Node::Base::hashChildren(size_t seed) const
+{
+    for (auto& child : *this)
+    {
+        seed = combineHash(seed, child ? child->getHash() : 0);
+    }
+    return seed;
+}
+
+size_t Node::Base::combineHash(size_t seed, size_t value)
+{
+    return seed ^ (value + static_cast<size_t>(0x9E3779B97F4A7C15ull) + (seed << 6) + (seed >> 2));
+}
+
+size_t Node::Base::hashIndex(const Pex::StringTable::Index &index)
+{
+    auto value = index.isValid() ? index.asIndex() : 0;
+    return combineHash(std::hash<const void*>()(index.getTable()), value);
+}
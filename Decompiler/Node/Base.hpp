@@ -54,6 +54,15 @@ public:
     virtual void computeInstructionBounds();
     void includeInstruction(size_t ip);
 
+    size_t getHash() const;
+    void invalidateHash();
+
+protected:
+    virtual size_t computeHash() const;
+    size_t hashChildren(size_t seed) const;
+    static size_t combineHash(size_t seed, size_t value);
+    static size_t hashIndex(const Pex::StringTable::Index& index);
+
 protected:
     size_t m_Begin;
     size_t m_End;
@@ -61,6 +70,8 @@ protected:
     uint8_t m_Precedence;
     Pex::StringTable::Index m_Result;
     Base* m_Parent{ nullptr };
+    mutable size_t m_Hash{ 0 };
+    mutable bool m_HashValid{ false };
 };
 
 }
@@ -38,6 +38,12 @@ public:
 
     const Pex::StringTable::Index& getMethod() const { return m_Method; }
 
+protected:
+    size_t computeHash() const override
+    {
+        return combineHash(Base::computeHash(), hashIndex(m_Method));
+    }
+
 private:
     Pex::StringTable::Index m_Method;
     bool m_Experimental;
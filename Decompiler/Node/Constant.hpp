@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <functional>
 
 #include "Base.hpp"
 #include "Visitor.hpp"
@@ -27,6 +28,28 @@ public:
 
     const Pex::Value& getConstant() const { return m_Constant; }
 
+protected:
+    size_t computeHash() const override
+    {
+        auto seed = combineHash(Base::computeHash(), static_cast<size_t>(m_Constant.getType()));
+        switch (m_Constant.getType())
+        {
+        case Pex::ValueType::Identifier:
+            return combineHash(seed, hashIndex(m_Constant.getId()));
+        case Pex::ValueType::String:
+            return combineHash(seed, hashIndex(m_Constant.getString()));
+        case Pex::ValueType::Integer:
+            return combineHash(seed, std::hash<std::int32_t>()(m_Constant.getInteger()));
+        case Pex::ValueType::Float:
+            // 0.0 and -0.0 are equal.
+            return combineHash(seed, m_Constant.getFloat() == 0.0f ? 0 : std::hash<float>()(m_Constant.getFloat()));
+        case Pex::ValueType::Bool:
+            return combineHash(seed, m_Constant.getBool());
+        default:
+            return seed;
+        }
+    }
+
 private:
     Pex::Value m_Constant;
 };
@@ -30,6 +30,12 @@ public:
 
     const Pex::StringTable::Index& getType() const { return m_Type; }
 
+protected:
+    size_t computeHash() const override
+    {
+        return combineHash(Base::computeHash(), hashIndex(m_Type));
+    }
+
 private:
     Pex::StringTable::Index m_Type;
 };
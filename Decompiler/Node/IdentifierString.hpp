@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <algorithm>
 #include <string>
 
@@ -29,6 +30,12 @@ public:
 
     const std::string& getIdentifier() const { return m_Identifier; }
 
+protected:
+    size_t computeHash() const override
+    {
+        return combineHash(Base::computeHash(), std::hash<std::string>()(m_Identifier));
+    }
+
 private:
     std::string m_Identifier;
 };
@@ -224,6 +224,11 @@ void Node::NodeComparer::visit(Node::EndGuard *node)
 
 bool Node::isSameTree(Node::BasePtr left, Node::BasePtr right)
 {
+    // Different hashes are enough to tell the trees apart, the full comparison only confirms a match.
+    if (left->getHash() != right->getHash())
+    {
+        return false;
+    }
     NodeComparer comparer(left);
     right->visit(&comparer);
     return comparer.getResult();
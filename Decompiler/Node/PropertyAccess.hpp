@@ -30,6 +30,12 @@ public:
 
     const Pex::StringTable::Index& getProperty() const { return m_Property; }
 
+protected:
+    size_t computeHash() const override
+    {
+        return combineHash(Base::computeHash(), hashIndex(m_Property));
+    }
+
 private:
     Pex::StringTable::Index m_Property;
 };
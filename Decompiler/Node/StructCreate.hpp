@@ -2,7 +2,9 @@
 
 #include <cassert>
 #include <cstdint>
+#include <typeinfo>
 
+#include "ArrayCreate.hpp"
 #include "Base.hpp"
 #include "Visitor.hpp"
 
@@ -26,6 +28,13 @@ public:
 
     const Pex::StringTable::Index& getType() const { return m_Type; }
 
+protected:
+    size_t computeHash() const override
+    {
+        // Compared as an ArrayCreate by isSameTree.
+        return combineHash(typeid(ArrayCreate).hash_code(), hashIndex(m_Type));
+    }
+
 private:
     const Pex::StringTable::Index& m_Type;
 };
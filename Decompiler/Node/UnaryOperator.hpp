@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <string>
 
 #include "Base.hpp"
@@ -31,6 +32,12 @@ public:
 
     const std::string& getOperator() const { return m_Op; }
 
+protected:
+    size_t computeHash() const override
+    {
+        return combineHash(Base::computeHash(), std::hash<std::string>()(m_Op));
+    }
+
 private:
     std::string m_Op;
 };
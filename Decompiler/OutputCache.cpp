@@ -0,0 +1,62 @@
+#include "OutputCache.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "FileWriter.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Constructor
+ * @param dir Directory of the cache, created when the first entry is stored.
+ */
+Decompiler::OutputCache::OutputCache(std::string dir) :
+    m_Dir(std::move(dir))
+{
+}
+
+/**
+ * @brief Read an entry.
+ * @param key Key of the entry.
+ * @param extension Extension of the output, "psc" or "pas".
+ * @param[out] content Receives the content of the entry.
+ * @return True if the entry exists.
+ */
+bool Decompiler::OutputCache::load(const std::string &key, const std::string &extension, std::string &content) const
+{
+    // Text mode, the entries are written with the platform line breaks.
+    std::ifstream stream(getPath(key, extension));
+    if (!stream)
+    {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << stream.rdbuf();
+    if (stream.bad())
+    {
+        return false;
+    }
+    content = buffer.str();
+    return true;
+}
+
+/**
+ * @brief Write an entry.
+ * @param key Key of the entry.
+ * @param extension Extension of the output, "psc" or "pas".
+ * @param content Content of the output.
+ */
+void Decompiler::OutputCache::store(const std::string &key, const std::string &extension, const std::string &content) const
+{
+    FileWriter writer(getPath(key, extension));
+    writer.writeContent(content);
+    writer.commit();
+}
+
+// The entries are spread in 256 directories by the first two digits of the key.
+std::string Decompiler::OutputCache::getPath(const std::string &key, const std::string &extension) const
+{
+    return (fs::path(m_Dir) / key.substr(0, 2) / (key + "." + extension)).string();
+}
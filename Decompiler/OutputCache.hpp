@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+namespace Decompiler {
+
+/**
+ * @brief On-disk cache of the decompiled and disassembled scripts.
+ *
+ * The entries are files named after their key, the hash of everything the output depends
+ * on: the content of the PEX file, the version of Champollion and the options. An entry is
+ * written to a temporary file then renamed, concurrent runs sharing a cache never read a
+ * partial entry.
+ */
+class OutputCache
+{
+public:
+    OutputCache(std::string dir);
+
+    bool load(const std::string& key, const std::string& extension, std::string& content) const;
+    void store(const std::string& key, const std::string& extension, const std::string& content) const;
+
+protected:
+    std::string getPath(const std::string& key, const std::string& extension) const;
+
+    std::string m_Dir;
+};
+
+}
@@ -18,5 +18,28 @@ public:
     virtual ~OutputWriter() = default;
 
     virtual void writeLine(const std::string& line) = 0;
+
+    /**
+     * @brief Start a new line in the line buffer of the writer.
+     * The buffer is reused from one line to the next, the indentation is written in place.
+     * @param indent Indentation level.
+     * @return The buffer receiving the content of the line.
+     */
+    std::string& beginLine(int indent)
+    {
+        m_Line.assign(static_cast<size_t>(indent) * 2, ' ');
+        return m_Line;
+    }
+
+    /**
+     * @brief Write the line built since the last call to beginLine.
+     */
+    void endLine()
+    {
+        writeLine(m_Line);
+    }
+
+protected:
+    std::string m_Line;
 };
 }
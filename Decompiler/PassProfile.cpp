@@ -0,0 +1,117 @@
+#include "PassProfile.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+
+static std::atomic<std::uint64_t (*)()> allocationCounter{nullptr};
+
+// Line of the table without the padding of an empty last column.
+static std::string trimRight(const char* line)
+{
+    std::string text(line);
+    text.erase(text.find_last_not_of(' ') + 1);
+    return text;
+}
+
+/**
+ * @brief Add the statistics of a pass.
+ * The statistics are summed with the previous runs of the same pass.
+ *
+ * @param entry Statistics of the pass.
+ */
+void Decompiler::PassProfile::add(const Entry &entry)
+{
+    for (auto& existing : m_Entries)
+    {
+        if (existing.name == entry.name)
+        {
+            existing.runs += entry.runs;
+            existing.time += entry.time;
+            existing.blocksBefore += entry.blocksBefore;
+            existing.blocksAfter += entry.blocksAfter;
+            existing.nodesBefore += entry.nodesBefore;
+            existing.nodesAfter += entry.nodesAfter;
+            existing.allocations += entry.allocations;
+            return;
+        }
+    }
+    m_Entries.push_back(entry);
+}
+
+/**
+ * @brief Add the statistics of another profile.
+ * @param other Profile to merge in this one.
+ */
+void Decompiler::PassProfile::merge(const PassProfile &other)
+{
+    for (auto& entry : other.m_Entries)
+    {
+        add(entry);
+    }
+}
+
+/**
+ * @brief Check if a pass has been recorded.
+ * @return True if the profile is empty.
+ */
+bool Decompiler::PassProfile::empty() const
+{
+    return m_Entries.empty();
+}
+
+/**
+ * @brief Get the statistics of the passes.
+ * @return The statistics, in the order the passes ran first.
+ */
+const std::vector<Decompiler::PassProfile::Entry> &Decompiler::PassProfile::getEntries() const
+{
+    return m_Entries;
+}
+
+/**
+ * @brief Format the profile as a table.
+ * The allocations are only written when an allocation counter is set.
+ *
+ * @param[out] lines Receives the lines of the table.
+ */
+void Decompiler::PassProfile::write(std::vector<std::string> &lines) const
+{
+    auto allocations = allocationCounter.load() != nullptr;
+    char line[160];
+    std::snprintf(line, sizeof(line), "  %-28s %8s %12s %12s %12s %12s %12s %12s",
+                  "pass", "runs", "time (ms)", "blocks in", "blocks out", "nodes in", "nodes out",
+                  allocations ? "allocations" : "");
+    lines.push_back(trimRight(line));
+    for (auto& entry : m_Entries)
+    {
+        std::snprintf(line, sizeof(line), "  %-28s %8zu %12.3f %12zu %12zu %12zu %12zu %12s",
+                      entry.name.c_str(), entry.runs,
+                      std::chrono::duration<double, std::milli>(entry.time).count(),
+                      entry.blocksBefore, entry.blocksAfter, entry.nodesBefore, entry.nodesAfter,
+                      allocations ? std::to_string(entry.allocations).c_str() : "");
+        lines.push_back(trimRight(line));
+    }
+}
+
+/**
+ * @brief Set the function counting the allocations.
+ * The library does not count the allocations itself, the application provides the counter,
+ * usually from its replacement of the global operator new.
+ *
+ * @param counter Function returning the number of allocations made so far by the calling thread.
+ */
+void Decompiler::PassProfile::setAllocationCounter(std::uint64_t (*counter)())
+{
+    allocationCounter = counter;
+}
+
+/**
+ * @brief Get the number of allocations made by the calling thread.
+ * @return The value of the allocation counter, 0 if no counter is set.
+ */
+std::uint64_t Decompiler::PassProfile::countAllocations()
+{
+    auto counter = allocationCounter.load();
+    return counter ? counter() : 0;
+}
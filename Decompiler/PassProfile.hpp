@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Decompiler {
+
+/**
+ * @brief Statistics of the decompilation passes.
+ *
+ * For each pass, the profile accumulates the number of runs, the time spent, the
+ * number of code blocks and tree nodes before and after the pass and, when the
+ * application sets an allocation counter, the number of allocations made during the
+ * pass. Profiles are merged to aggregate files into a run.
+ */
+class PassProfile
+{
+public:
+    struct Entry
+    {
+        std::string name;
+        size_t runs;
+        std::chrono::steady_clock::duration time;
+        size_t blocksBefore;
+        size_t blocksAfter;
+        size_t nodesBefore;
+        size_t nodesAfter;
+        std::uint64_t allocations;
+    };
+
+    void add(const Entry& entry);
+    void merge(const PassProfile& other);
+    bool empty() const;
+    const std::vector<Entry>& getEntries() const;
+    void write(std::vector<std::string>& lines) const;
+
+    static void setAllocationCounter(std::uint64_t (*counter)());
+    static std::uint64_t countAllocations();
+
+protected:
+    std::vector<Entry> m_Entries;
+};
+
+}
@@ -40,16 +40,12 @@ void Decompiler::PscCodeGenerator::newLine()
         }
         m_ExperimentalSyntaxWarning.clear();
     }
-    auto nums = getDebugInfoLineNumbers(minIpForCurrentLine, maxIpForCurrentLine);
+    m_Decompiler->getLineIndex().getLines(minIpForCurrentLine, maxIpForCurrentLine, m_LineNumbers);
     resetIpsForCurrentLine();
     m_Decompiler->push_back(m_Result.str());
-    m_Decompiler->addLineMapping(m_Decompiler->size() - 1, nums);
+    m_Decompiler->addLineMapping(m_Decompiler->size() - 1, m_LineNumbers);
 
-    m_Result = std::ostringstream();
-    for (auto i = 0; i < m_Level; ++i)
-    {
-        m_Result << ' ' << ' ';
-    }
+    m_Result.reset(m_Level);
 }
 
 void Decompiler::PscCodeGenerator::visit(Node::Scope* node)
@@ -300,7 +296,7 @@ void Decompiler::PscCodeGenerator::visit(Node::Constant* node)
     addIpRangeForCurrentLine(node->getBegin(), node->getEnd());
     auto& value = node->getConstant();
 
-    m_Result << value.toString();
+    m_Result << value;
 }
 
 void Decompiler::PscCodeGenerator::visit(Node::IdentifierString *node)
@@ -432,7 +428,3 @@ void Decompiler::PscCodeGenerator::resetIpsForCurrentLine() {
     maxIpForCurrentLine = -1;
 }
 
-std::vector<uint16_t> Decompiler::PscCodeGenerator::getDebugInfoLineNumbers(int64_t begin, int64_t end) {
-    return m_Decompiler->getDebugInfo().getLineNumbersForIpRange(begin, end);
-}
-
@@ -2,8 +2,9 @@
 
 #include "Node/Visitor.hpp"
 #include "PscDecompiler.hpp"
+#include "LineBuffer.hpp"
 
-#include <sstream>
+#include <string>
 
 namespace Decompiler
 {
@@ -50,14 +51,14 @@ public:
 protected:    
     void newLine();
     void addIpRangeForCurrentLine(int64_t begin, int64_t end);
-    std::ostringstream m_Result;
+    LineBuffer m_Result;
     int64_t minIpForCurrentLine{ -1 };
     int64_t maxIpForCurrentLine{ -1 };
     std::uint8_t m_Level{ 0 };
     std::vector<std::string> m_ExperimentalSyntaxWarning{};
+    std::vector<uint16_t> m_LineNumbers;
     Decompiler::PscDecompiler* m_Decompiler;
 
-    std::vector<uint16_t> getDebugInfoLineNumbers(int64_t begin, int64_t end);
     void resetIpsForCurrentLine();
 };
 
@@ -11,6 +11,7 @@
 #include <regex>
 
 #include "PscDecompiler.hpp"
+#include "TraceSink.hpp"
 #include "Version.hpp"
 #include "EventNames.hpp"
 
@@ -23,7 +24,7 @@
  * @param writeHeader True to write the header (default: false).
  * @param traceDecompilation True to output decompilation tracing to the rebuild log (default: false).
  * @param dumpTree True to output the entire tree for each block (true by default if traceDecompilation is true).
- * @param traceDir If tracing is enabled, write rebuild logs to this dir (default is cwd)
+ * @param traceDir If tracing is enabled, write the rebuild log of each script to this dir (default is cwd)
  */
 Decompiler::PscCoder::PscCoder( OutputWriter* writer,
                                 bool commentAsm = false,
@@ -40,7 +41,13 @@ Decompiler::PscCoder::PscCoder( OutputWriter* writer,
     m_DumpTree(dumpTree), // Note that while dumpTree is true by default, it will not do anything unless traceDecompilation is true
     m_WriteDebugFuncs(writeDebugFuncs),
     m_OutputDir(traceDir),
-    m_PrintDebugLineNo(printDebugLineNo)
+    m_PrintDebugLineNo(printDebugLineNo),
+    m_TraceBudget(0),
+    m_Profile(nullptr),
+    m_DisabledPasses(0),
+    m_FunctionCache(nullptr),
+    m_Limits(nullptr),
+    m_FallbackCount(0)
 {
     
 }
@@ -59,7 +66,13 @@ Decompiler::PscCoder::PscCoder(Decompiler::OutputWriter *writer)  :
     m_DumpTree(true),
     m_WriteDebugFuncs(false),
     m_PrintDebugLineNo(false),
-    m_OutputDir("")
+    m_OutputDir(""),
+    m_TraceBudget(0),
+    m_Profile(nullptr),
+    m_DisabledPasses(0),
+    m_FunctionCache(nullptr),
+    m_Limits(nullptr),
+    m_FallbackCount(0)
 {
 }
 
@@ -80,11 +93,124 @@ void Decompiler::PscCoder::code(const Pex::Binary &pex)
     {
         writeHeader(pex);
     }
-    for(auto& object : pex.getObjects())
+    try
     {
-        writeObject(object, pex);
+        for(auto& object : pex.getObjects())
+        {
+            m_Symbols.setObject(object);
+            writeObject(object, pex);
+        }
+    }
+    catch(const std::exception& ex)
+    {
+        // The trace of the failing function is the one worth keeping.
+        if (m_Recorder.isRecording())
+        {
+            m_Flight << "=== FAILED FUNCTION : " << m_Recorder.getFunction() << " : " << ex.what() << '\n';
+            m_Recorder.dump(m_Flight);
+            m_Recorder.stop();
+        }
+        writeTrace(pex);
+        throw;
+    }
+    writeTrace(pex);
+}
+
+/**
+ * @brief Hand the rebuild log and the flight records of the script over to the trace sink.
+ * All the functions of a script are traced in a single rebuild-<object>.txt file.
+ * The flight records of the failing or slow functions are written to flight-<object>.txt.
+ * @param pex Binary being decompiled.
+ */
+void Decompiler::PscCoder::writeTrace(const Pex::Binary &pex)
+{
+    if (pex.getObjects().empty())
+    {
+        return;
     }
+    auto filename = pex.getObjects()[0].getName().asString() + ".txt";
+    std::replace(filename.begin(), filename.end(), '#', '_');
+    std::replace(filename.begin(), filename.end(), ':', '_');
+    auto prefix = !m_OutputDir.empty() ? m_OutputDir + "/" : std::string();
 
+    if (m_TraceDecompilation)
+    {
+        TraceSink::instance().write(prefix + "rebuild-" + filename, m_Trace.str());
+        m_Trace.str("");
+    }
+    if (m_Flight.tellp() > 0)
+    {
+        TraceSink::instance().write(prefix + "flight-" + filename, m_Flight.str());
+        m_Flight.str("");
+    }
+}
+
+/**
+ * @brief Set the time budget of a function decompilation.
+ * The flight records of the functions exceeding the budget are written next to the rebuild logs.
+ * @param budget Time budget, zero to disable.
+ * @return A reference to this.
+ */
+Decompiler::PscCoder &Decompiler::PscCoder::outputTraceBudget(std::chrono::milliseconds budget)
+{
+    m_TraceBudget = budget;
+    return *this;
+}
+
+/**
+ * @brief Set the profile receiving the statistics of the decompilation passes.
+ * @param profile Profile to fill, null to disable profiling.
+ * @return A reference to this.
+ */
+Decompiler::PscCoder &Decompiler::PscCoder::outputPassProfile(PassProfile *profile)
+{
+    m_Profile = profile;
+    return *this;
+}
+
+/**
+ * @brief Set the optional decompilation passes to skip.
+ * @param disabledPasses Mask of the passes, the bit N matching the pass N of PscDecompiler::getPasses.
+ * @return A reference to this.
+ */
+Decompiler::PscCoder &Decompiler::PscCoder::disablePasses(std::uint32_t disabledPasses)
+{
+    m_DisabledPasses = disabledPasses;
+    return *this;
+}
+
+/**
+ * @brief Set the cache of the decompiled functions.
+ * The cache is not used while tracing or profiling the decompilation.
+ * @param cache Cache shared with the other coders, null to decompile every function.
+ * @return A reference to this.
+ */
+Decompiler::PscCoder &Decompiler::PscCoder::useFunctionCache(FunctionCache *cache)
+{
+    m_FunctionCache = cache;
+    return *this;
+}
+
+/**
+ * @brief Set the limits of the decompilation of each function.
+ * A function exceeding the limits, or failing to decompile, is written as commented assembly
+ * and the rest of the script is decompiled.
+ * @param limits Limits shared with the other coders, null to let a failing function fail the script.
+ * @return A reference to this.
+ */
+Decompiler::PscCoder &Decompiler::PscCoder::limitFunctions(const PscDecompiler::Limits *limits)
+{
+    m_Limits = limits;
+    return *this;
+}
+
+/**
+ * @brief Get the number of functions written as assembly.
+ * @return The number of functions which exceeded the limits or failed to decompile.
+ */
+size_t Decompiler::PscCoder::getFallbackCount() const
+{
+    return m_FallbackCount;
 }
 
 /**
@@ -144,14 +270,14 @@ void Decompiler::PscCoder::writeHeader(const Pex::Binary &pex)
     write(indent(0) << "Source   : " << header.getSourceFileName());
     if (debug.getModificationTime() != 0)
     {
-        write(indent(0) << "Modified : " << std::put_time(std::localtime(&debug.getModificationTime()), "%Y-%m-%d %H:%M:%S"));
+        write(indent(0) << "Modified : " << Pex::Format::localTime(debug.getModificationTime()));
         //for (auto& f : debug.getFunctionInfos()) {
         //  write(indent(0) << f.getObjectName().asString() << ":" << f.getStateName().asString() << ":" << f.getFunctionName().asString() << " type: " << (int)f.getFunctionType());
         //  for (auto& l : f.getLineNumbers())
         //    write(indent(1) << "Line: " << l);
         //}
     }
-    write(indent(0) << "Compiled : " << std::put_time(std::localtime(&header.getCompilationTime()), "%Y-%m-%d %H:%M:%S"));
+    write(indent(0) << "Compiled : " << Pex::Format::localTime(header.getCompilationTime()));
     write(indent(0) << "User     : " << header.getUserName());
     write(indent(0) << "Computer : " << header.getComputerName());
     write("/;");
@@ -160,21 +286,11 @@ void Decompiler::PscCoder::writeHeader(const Pex::Binary &pex)
 bool Decompiler::PscCoder::isNativeObject(const Pex::Object &object, const Pex::Binary::ScriptType &scriptType) const {
     if (scriptType == Pex::Binary::ScriptType::Fallout4Script)
     {
-        for (auto& native : Fallout4::NativeClasses)
-        {
-            if (_stricmp(object.getName().asString().c_str(), native.c_str()) == 0){
-                return true;
-            }
-        }
+        return Fallout4::NativeClasses.contains(object.getName().asString());
     }
     else if (scriptType == Pex::Binary::ScriptType::StarfieldScript)
     {
-        for (auto& native : Starfield::NativeClasses)
-        {
-            if (_stricmp(object.getName().asString().c_str(), native.c_str()) == 0){
-                return true;
-            }
-        }
+        return Starfield::NativeClasses.contains(object.getName().asString());
     }
     return false;
 }
@@ -200,7 +316,7 @@ void Decompiler::PscCoder::writeObject(const Pex::Object &object, const Pex::Bin
       stream << " Const";
 
     writeUserFlag(stream, object, pex);
-    write(stream.str());
+    write(stream);
 
     writeDocString(0, object);
 
@@ -293,12 +409,12 @@ void Decompiler::PscCoder::writeStructMember(const Pex::StructInfo::Member& memb
     stream << mapType(member.getTypeName().asString()) << " " << member.getName().asString();
 
     if (member.getValue().getType() != Pex::ValueType::None) {
-        stream << " = " << member.getValue().toString();
+        stream << " = " << member.getValue();
     }
     writeUserFlag(stream, member, pex);
     if (member.getConstFlag())
       stream << " Const";
-    write(stream.str());
+    write(stream);
     writeDocString(1, member);
 }
 
@@ -330,7 +446,7 @@ void Decompiler::PscCoder::writeProperties(const Pex::Object &object, const Pex:
                         auto stream = indent(0);
                         stream << "Group " << propGroup.getGroupName();
                         writeUserFlag(stream, propGroup, pex);
-                        write(stream.str());
+                        write(stream);
                         writeDocString(0, propGroup);
                         propertyIndent = 1;
                     }
@@ -390,7 +506,7 @@ void Decompiler::PscCoder::writeProperty(int i, const Pex::Property& prop, const
 
         auto initialValue = var->getDefaultValue();
         if (initialValue.getType() != Pex::ValueType::None)
-            stream << " = " << initialValue.toString();
+            stream << " = " << initialValue;
         stream << " Auto";
 
         // The flags defined on the variable must be set on the property
@@ -398,11 +514,11 @@ void Decompiler::PscCoder::writeProperty(int i, const Pex::Property& prop, const
         if (var->getConstFlag())
           stream << " Const";
     } else if (isAutoReadOnly) {
-      stream << " = " << prop.getReadFunction().getInstructions()[0].getArgs()[0].toString();
+      stream << " = " << prop.getReadFunction().getInstructions()[0].getArgs()[0];
       stream << " AutoReadOnly";
     }
     writeUserFlag(stream, prop, pex);
-    write(stream.str());
+    write(stream);
     writeDocString(i, prop);
 
     if (!prop.hasAutoVar() && !isAutoReadOnly) {
@@ -434,7 +550,7 @@ void Decompiler::PscCoder::writeVariables(const Pex::Object &object, const Pex::
         auto initialValue = var.getDefaultValue();
         if (initialValue.getType() != Pex::ValueType::None)
         {
-            stream << " = " << initialValue.toString();
+            stream << " = " << initialValue;
         }
         writeUserFlag(stream, var, pex);
         if (var.getConstFlag())
@@ -442,7 +558,7 @@ void Decompiler::PscCoder::writeVariables(const Pex::Object &object, const Pex::
 
         if (m_CommentAsm || !compilerGenerated)
         {
-            write(stream.str());
+            write(stream);
         }
     }
 }
@@ -488,7 +604,8 @@ void Decompiler::PscCoder::writeStates(const Pex::Object &object, const Pex::Bin
             {
                 stream << "Auto ";
             }
-            write(stream.str() + "State " + state.getName().asString());
+            stream << "State " << state.getName().asString();
+            write(stream);
             writeFunctions(1, state, object, pex);
             write(indent(0) << "EndState");
         }
@@ -536,20 +653,12 @@ void Decompiler::PscCoder::writeFunction(int i, const Pex::Function &function, c
     if (functionName.size() > 2 && !_stricmp(functionName.substr(0, 2).c_str(), "on")) {
         // We'd have to check for full inheritence to do this by object type
         // Right now, we're just seeing if matches all the built-in event names.
-        std::string functionLower = functionName;
-        std::transform(functionLower.begin(), functionLower.end(), functionLower.begin(), ::tolower);
         if (pex.getGameType() == Pex::Binary::ScriptType::SkyrimScript){
-            if (std::find(Skyrim::EventNamesLowerCase.begin(), Skyrim::EventNamesLowerCase.end(), functionLower) != Skyrim::EventNamesLowerCase.end()) {
-                isEvent = true;
-            }
+            isEvent = Skyrim::EventNames.contains(functionName);
         } else if (pex.getGameType() == Pex::Binary::ScriptType::Fallout4Script){
-            if (std::find(Fallout4::EventNamesLowerCase.begin(), Fallout4::EventNamesLowerCase.end(), functionLower) != Fallout4::EventNamesLowerCase.end()) {
-                isEvent = true;
-            }
+            isEvent = Fallout4::EventNames.contains(functionName);
         } else if (pex.getGameType() == Pex::Binary::ScriptType::StarfieldScript) {
-            if (std::find(Starfield::EventNamesLowerCase.begin(), Starfield::EventNamesLowerCase.end(), functionLower) != Starfield::EventNamesLowerCase.end()) {
-                isEvent = true;
-            }
+            isEvent = Starfield::EventNames.contains(functionName);
         }
     }
 
@@ -598,12 +707,22 @@ void Decompiler::PscCoder::writeFunction(int i, const Pex::Function &function, c
     {
         stream << " Native";
         writeUserFlag(stream, function, pex);
-        write(stream.str());
+        write(stream);
         writeDocString(i, function);
     } else {
-        auto decomp = PscDecompiler(function, object, functionInfo, m_CommentAsm, m_TraceDecompilation, m_DumpTree,
-                                    m_OutputDir);
-        if (decomp.isDebugFunction()) {
+        auto label = functionName;
+        if (!name.empty() && functionInfo)
+        {
+            label = functionInfo->getFunctionName().asString() + "." + functionName;
+        }
+        if (m_TraceDecompilation)
+        {
+            m_Trace << "=== FUNCTION : " << label << std::endl;
+        }
+        FunctionCache::Entry body;
+        decompileFunction(function, object, functionInfo, label, body);
+        auto& decomp = body.lines;
+        if (PscDecompiler::isDebugFunction(decomp)) {
             // Starfield debug function fixup hacks
             // These functions were supposed to have been compiled out of the pex, but the compiler left it in without restoring whatever the temp variable pointed to
             // This causes the recompilation to fail, so we need to replace the temp variable with false
@@ -667,26 +786,27 @@ void Decompiler::PscCoder::writeFunction(int i, const Pex::Function &function, c
 
 
         writeUserFlag(stream, function, pex);
-        write(stream.str());
+        write(stream);
         writeDocString(i, function);
-        auto index = 0;
+        auto& linemap = body.lineMap;
+        size_t index = 0;
         for (auto &line: decomp) {
-            auto & linemap = decomp.getLineMap();
+            auto& output = m_Writer->beginLine(i + 1);
+            output += line;
             if (m_PrintDebugLineNo){
-              // get index of line
-              auto result = linemap[index];
-              if (result.size() > 0){
-                line += " ; #DEBUG_LINE_NO:";
-                for (auto i = 0; i < result.size(); ++i)
+              auto result = linemap.get(index);
+              if (result.first != result.second){
+                output += " ; #DEBUG_LINE_NO:";
+                for (auto it = result.first; it != result.second; ++it)
                 {
-                    if (i > 0){
-                    line += ",";
+                    if (it != result.first){
+                      output += ',';
                     }
-                    line += std::to_string(result[i]);
+                    Pex::Format::appendInteger(output, *it);
                 }
               }
             }
-            write(indent(i+1) << line);
+            m_Writer->endLine();
             index++;
         }
         if (isEvent)
@@ -697,13 +817,71 @@ void Decompiler::PscCoder::writeFunction(int i, const Pex::Function &function, c
 
 }
 
+/**
+ * @brief Decompile the body of a function.
+ * Functions already decompiled with the same code are taken from the function cache.
+ *
+ * @param function The function to decompile.
+ * @param object The Object containing the function.
+ * @param functionInfo Debug info of the function, null if none.
+ * @param label Name of the function in the traces.
+ * @param[out] body Receives the decompiled lines and their debug line numbers.
+ */
+void Decompiler::PscCoder::decompileFunction(const Pex::Function &function, const Pex::Object &object,
+                                             const Pex::DebugInfo::FunctionInfo *functionInfo,
+                                             const std::string &label, FunctionCache::Entry &body)
+{
+    std::string key;
+    std::uint16_t baseLine = 0;
+    if (m_FunctionCache && !m_TraceDecompilation && !m_DumpTree && !m_Profile && m_TraceBudget.count() == 0)
+    {
+        if (m_Symbols.getObject() != &object)
+        {
+            m_Symbols.setObject(object);
+        }
+        m_Symbols.setFunction(function);
+        key = FunctionCache::makeKey(function, functionInfo, m_Symbols, m_CommentAsm, m_DisabledPasses, baseLine);
+        if (m_FunctionCache->find(key, baseLine, body))
+        {
+            return;
+        }
+    }
+
+    m_Recorder.start(label);
+    auto decomp = PscDecompiler(function, object, functionInfo, m_CommentAsm, m_TraceDecompilation, m_DumpTree,
+                                &m_Trace, &m_Recorder, &m_Symbols,
+                                m_Profile, m_DisabledPasses, m_Limits);
+    auto& fallback = decomp.getFallbackReason();
+    if (!fallback.empty())
+    {
+        ++m_FallbackCount;
+        m_Flight << "=== FALLBACK FUNCTION : " << label << " : " << fallback << '\n';
+        m_Recorder.dump(m_Flight);
+    }
+    else if (m_TraceBudget.count() > 0 && m_Recorder.elapsed() > m_TraceBudget)
+    {
+        m_Flight << "=== SLOW FUNCTION : " << label << " : "
+                 << std::chrono::duration_cast<std::chrono::milliseconds>(m_Recorder.elapsed()).count() << " ms\n";
+        m_Recorder.dump(m_Flight);
+    }
+    m_Recorder.stop();
+
+    body.lineMap = decomp.getLineMap();
+    body.lines = std::move(static_cast<std::vector<std::string>&>(decomp));
+    // The limits may not be exceeded by the next run, the assembly is not kept
+    if (!key.empty() && fallback.empty())
+    {
+        m_FunctionCache->insert(key, baseLine, body);
+    }
+}
+
 /**
  * @brief Write the user flags associated with an item.
- * @param stream Stream to write the flags to.
+ * @param stream Line to write the flags to.
  * @param flagged Flagged item.
  * @param pex Binary to decompile.
  */
-void Decompiler::PscCoder::writeUserFlag(std::ostream& stream, const Pex::UserFlagged &flagged, const Pex::Binary &pex)
+void Decompiler::PscCoder::writeUserFlag(LineBuffer& stream, const Pex::UserFlagged &flagged, const Pex::Binary &pex)
 {
     auto flags = flagged.getUserFlags();
     for (auto& flag : pex.getUserFlags())
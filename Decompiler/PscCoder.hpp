@@ -1,5 +1,12 @@
 #pragma once
+#include <chrono>
+#include <sstream>
+
 #include "Coder.hpp"
+#include "FlightRecorder.hpp"
+#include "FunctionCache.hpp"
+#include "PassProfile.hpp"
+#include "SymbolTable.hpp"
 
 
 namespace Decompiler {
@@ -22,10 +29,17 @@ public:
     PscCoder& outputDumpTree(bool dumpTree);
     PscCoder& outputAsmComment(bool commentAsm);
     PscCoder& outputWriteHeader(bool writeHeader);
+    PscCoder& outputTraceBudget(std::chrono::milliseconds budget);
+    PscCoder& outputPassProfile(PassProfile* profile);
+    PscCoder& disablePasses(std::uint32_t disabledPasses);
+    PscCoder& useFunctionCache(FunctionCache* cache);
+    PscCoder& limitFunctions(const PscDecompiler::Limits* limits);
+    size_t getFallbackCount() const;
     static std::string mapType(std::string type);
 protected:
 
     void writeHeader(const Pex::Binary& pex);
+    void writeTrace(const Pex::Binary& pex);
     void writeObject(const Pex::Object& object, const Pex::Binary& pex);
     void writeStructs(const Pex::Object& object, const Pex::Binary& pex);
     void writeStructMember(const Pex::StructInfo::Member& member, const Pex::Binary& pex);
@@ -38,8 +52,11 @@ protected:
     void writeFunction(int i, const Pex::Function &function, const Pex::Object &object,
                        const Pex::Binary &pex, const Pex::DebugInfo::FunctionInfo *functionInfo,
                        const std::string &name = "");
+    void decompileFunction(const Pex::Function &function, const Pex::Object &object,
+                           const Pex::DebugInfo::FunctionInfo *functionInfo, const std::string &label,
+                           FunctionCache::Entry &body);
 
-    void writeUserFlag(std::ostream &stream, const Pex::UserFlagged& flagged, const Pex::Binary& pex);
+    void writeUserFlag(LineBuffer &stream, const Pex::UserFlagged& flagged, const Pex::Binary& pex);
     void writeDocString(int i, const Pex::DocumentedItem& item);
 
 protected:
@@ -50,6 +67,16 @@ protected:
     bool m_WriteDebugFuncs;
     bool m_PrintDebugLineNo;
     std::string m_OutputDir;
+    std::ostringstream m_Trace;
+    FlightRecorder m_Recorder;
+    SymbolTable m_Symbols;
+    std::ostringstream m_Flight;
+    std::chrono::milliseconds m_TraceBudget;
+    PassProfile* m_Profile;
+    std::uint32_t m_DisabledPasses;
+    FunctionCache* m_FunctionCache;
+    const PscDecompiler::Limits* m_Limits;
+    size_t m_FallbackCount;
 
 
 
@@ -1,18 +1,20 @@
 #include "PscDecompiler.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <cstdint>
 #include <iostream>
 #include <iomanip>
 #include <iterator>
-#include <atomic>
-#include <mutex>
 
 #include "Node/Nodes.hpp"
 #include "Node/WithNode.hpp"
 #include "Node/NodeComparer.hpp"
 
 #include "PscCodeGenerator.hpp"
+#include "PscCoder.hpp"
+#include "LineBuffer.hpp"
 
 static inline
 bool isTempVar(const Pex::StringTable::Index& var)
@@ -44,7 +46,22 @@ std::string getVarName(const Pex::StringTable::Index& var)
     return name;
 }
 
-static std::atomic_size_t unnamed_num{0};
+namespace {
+
+/**
+ * @brief Count a nesting level for the lifetime of the guard.
+ */
+class DepthGuard
+{
+public:
+    explicit DepthGuard(size_t& depth) : m_Depth(depth) { ++m_Depth; }
+    ~DepthGuard() { --m_Depth; }
+
+protected:
+    size_t& m_Depth;
+};
+
+}
 
 /**
  * @brief Constructor.
@@ -55,45 +72,39 @@ static std::atomic_size_t unnamed_num{0};
  * @param commentAsm True to output assembly instruction comments.
  * @param traceDecompilation True to output decompilation tracing to the rebuild log.
  * @param dumpTree True to output the entire tree for each block (true by default if traceDecompilation is true).
+ * @param traceLog Stream receiving the rebuild log. Tracing is disabled if null.
+ * @param recorder Flight recorder receiving the decompilation events, or null.
+ * @param symbols Variables of the object, shared by the functions of the object. A table is built if null.
+ * @param profile Profile receiving the statistics of the passes, or null.
+ * @param disabledPasses Mask of the optional passes to skip, the bit N matching the pass N of getPasses.
+ * @param limits Limits of the decompilation, or null. With limits, a function exceeding them or failing to
+ *               decompile is written as commented assembly instead of throwing.
  */
 Decompiler::PscDecompiler::PscDecompiler(const Pex::Function &function, const Pex::Object &object,
                                          const Pex::DebugInfo::FunctionInfo *debugInfo, bool commentAsm = false,
                                          bool traceDecompilation = false, bool dumpTree = true,
-                                         std::string outputDir = "") :
+                                         std::ostream *traceLog = nullptr, FlightRecorder *recorder = nullptr,
+                                         SymbolTable *symbols = nullptr, PassProfile *profile = nullptr,
+                                         std::uint32_t disabledPasses = 0, const Limits *limits = nullptr) :
+    m_Symbols(symbols),
     m_Function(function),
     m_Object(object),
+    m_Trivial(false),
     m_CommentAsm(commentAsm),
-    m_TraceDecompilation(traceDecompilation),
+    m_TraceDecompilation(traceDecompilation && traceLog != nullptr),
     m_DumpTree(dumpTree), // Note that while dumpTree is true by default, it will not do anything unless traceDecompilation is true
     m_DebugInfo(debugInfo ? *debugInfo : Pex::DebugInfo::FunctionInfo()),
-    m_OutputDir(outputDir)
+    m_LineIndex(m_DebugInfo.getLineNumbers()),
+    m_Log(traceLog ? traceLog->rdbuf() : nullptr),
+    m_Recorder(recorder),
+    m_Profile(profile),
+    m_DisabledPasses(disabledPasses),
+    m_DropNoneResults(false),
+    m_BooleanDepth(0),
+    m_Limits(limits),
+    m_Start(std::chrono::steady_clock::now()),
+    m_Depth(0)
 {
-    if (m_TraceDecompilation)
-    {
-        auto fileprefix = std::string("rebuild-") + object.getName()
-                + "-";     
-        std::string filename;
-        if (function.getName().isValid()){
-            filename = fileprefix + function.getName() + ".txt";
-        } else {
-            fileprefix += "unnamed";
-            // in case of parallel execution
-            static std::mutex unnamed_num_mutex;
-            std::lock_guard m(unnamed_num_mutex);
-            filename = fileprefix + std::to_string(++unnamed_num) + ".txt";
-        }
-        std::replace(filename.begin(), filename.end(), '#', '_');
-        std::replace(filename.begin(), filename.end(), ':', '_');
-        std::string filepath = !m_OutputDir.empty() ? m_OutputDir + "/" + filename : filename;
-        m_Log.open(filepath);
-        if (m_Log.fail())
-        {
-            m_TraceDecompilation = false;
-            static std::mutex cerr_mutex;
-            std::lock_guard m(cerr_mutex);
-            std::cerr << "Failed to open " << filepath << ", tracing disabled." << std::endl;
-        }
-    }
     if (m_Function.getInstructions().size() == 0)
     {
         push_back("; Empty function");
@@ -101,53 +112,195 @@ Decompiler::PscDecompiler::PscDecompiler(const Pex::Function &function, const Pe
     else
     {
         m_ReturnNone = (m_Function.getReturnTypeName() == m_Object.getName().getTable()->findIdentifier("NONE"));
-        m_TempTable.push_back("true");
-        m_TempTable.push_back("false");
-
-        m_TempTable.push_back("find");
-        m_TempTable.push_back("findstruct");
-        m_TempTable.push_back("rfind");
-        m_TempTable.push_back("rfindstruct");
-        m_TempTable.push_back("add");
-        m_TempTable.push_back("insert");
-        m_TempTable.push_back("removelast");
-        m_TempTable.push_back("remove");
-        m_TempTable.push_back("clear");
-        m_TempTable.push_back("GetMatchingStructs"); // TODO: VERIFY: Need to verify syntax when CK for Starfield comes out
 
         //findReplacedVars();
-        findVarTypes();
-
-        createFlowBlocks();
-
-        rebuildExpressionsInBlocks();
+        Node::BasePtr programTree;
+        auto& passes = getPasses();
+        try
+        {
+            for (size_t i = 0; i < passes.size() && !m_Trivial; ++i)
+            {
+                if (passes[i].optional && (m_DisabledPasses & (1u << i)) != 0)
+                {
+                    continue;
+                }
+                checkLimits();
+                runPass(passes[i], programTree);
+                if (m_Limits && m_Limits->nodes != 0 && countNodes(programTree) > m_Limits->nodes)
+                {
+                    throw std::runtime_error("More than " + std::to_string(m_Limits->nodes) + " nodes after "
+                                             + passes[i].name);
+                }
+            }
+        }
+        catch (const std::exception& ex)
+        {
+            if (m_Limits == nullptr)
+            {
+                throw;
+            }
+            writeAsmFallback(ex.what());
+        }
 
-        rebuildBooleanOperators(0, m_Function.getInstructions().size());
+    }
+}
 
+/**
+ * @brief Destructor
+ */
+Decompiler::PscDecompiler::~PscDecompiler()
+{
+    for (auto& bloc_kv : m_CodeBlocs)
+    {
+        auto& bloc = bloc_kv.second;
+        delete bloc;
+    }
+}
 
-        Node::BasePtr programTree = rebuildControlFlow(0, m_Function.getInstructions().size());
+/**
+ * @brief Get the decompilation passes.
+ * @return The passes, in the order they run.
+ */
+const std::vector<Decompiler::PscDecompiler::Pass> &Decompiler::PscDecompiler::getPasses()
+{
+    static const std::vector<Pass> passes = {
+        {"findVarTypes", false, [](PscDecompiler& decompiler, Node::BasePtr&) {
+            decompiler.findVarTypes();
+        }},
+        {"decompileTrivialFunction", true, [](PscDecompiler& decompiler, Node::BasePtr&) {
+            decompiler.decompileTrivialFunction();
+        }},
+        {"normalizeInstructions", true, [](PscDecompiler& decompiler, Node::BasePtr&) {
+            decompiler.normalizeInstructions();
+        }},
+        {"createFlowBlocks", false, [](PscDecompiler& decompiler, Node::BasePtr&) {
+            decompiler.createFlowBlocks();
+        }},
+        {"rebuildExpressionsInBlocks", false, [](PscDecompiler& decompiler, Node::BasePtr&) {
+            decompiler.rebuildExpressionsInBlocks();
+        }},
+        {"rebuildBooleanOperators", true, [](PscDecompiler& decompiler, Node::BasePtr&) {
+            decompiler.rebuildBooleanOperators(0, decompiler.m_Function.getInstructions().size());
+        }},
+        {"rebuildControlFlow", false, [](PscDecompiler& decompiler, Node::BasePtr& program) {
+            program = decompiler.rebuildControlFlow(0, decompiler.m_Function.getInstructions().size());
+        }},
+        {"declareVariables", true, [](PscDecompiler& decompiler, Node::BasePtr& program) {
+            decompiler.declareVariables(program);
+        }},
+        {"rebuildLocks", true, [](PscDecompiler& decompiler, Node::BasePtr& program) {
+            decompiler.rebuildLocks(program);
+        }},
+        {"cleanUpTree", true, [](PscDecompiler& decompiler, Node::BasePtr& program) {
+            decompiler.cleanUpTree(program);
+        }},
+        {"generateCode", false, [](PscDecompiler& decompiler, Node::BasePtr& program) {
+            decompiler.generateCode(program);
+        }},
+    };
+    return passes;
+}
 
-        declareVariables(programTree);
+/**
+ * @brief Run a decompilation pass.
+ * When profiling, the statistics of the pass are added to the profile.
+ *
+ * @param pass Pass to run.
+ * @param program Tree of the function, null until the control flow is rebuilt.
+ */
+void Decompiler::PscDecompiler::runPass(const Pass &pass, Node::BasePtr &program)
+{
+    record(FlightRecorder::Event::Pass, pass.name, m_CodeBlocs.size());
+    if (m_Profile == nullptr)
+    {
+        pass.run(*this, program);
+        return;
+    }
 
-        rebuildLocks(programTree);
+    PassProfile::Entry entry{};
+    entry.name = pass.name;
+    entry.runs = 1;
+    entry.blocksBefore = m_CodeBlocs.size();
+    entry.nodesBefore = countNodes(program);
+    auto allocations = PassProfile::countAllocations();
+    auto start = std::chrono::steady_clock::now();
+
+    pass.run(*this, program);
+
+    entry.time = std::chrono::steady_clock::now() - start;
+    entry.allocations = PassProfile::countAllocations() - allocations;
+    entry.blocksAfter = m_CodeBlocs.size();
+    entry.nodesAfter = countNodes(program);
+    m_Profile->add(entry);
+}
 
-        cleanUpTree(programTree);
+/**
+ * @brief Check the time spent on the function and the recursion depth against the limits.
+ * The check is cheap, it is made between the passes and in the loops of the long passes.
+ */
+void Decompiler::PscDecompiler::checkLimits() const
+{
+    if (m_Limits == nullptr)
+    {
+        return;
+    }
+    if (m_Limits->depth != 0 && m_Depth > m_Limits->depth)
+    {
+        throw std::runtime_error("Control flow nested deeper than " + std::to_string(m_Limits->depth) + " levels");
+    }
+    if (m_Limits->time.count() != 0 && std::chrono::steady_clock::now() - m_Start > m_Limits->time)
+    {
+        throw std::runtime_error("Decompilation longer than " + std::to_string(m_Limits->time.count()) + " ms");
+    }
+}
 
-        generateCode(programTree);
+/**
+ * @brief Replace the decompiled lines by the assembly of the whole function.
+ * The function keeps an empty body, the assembly is commented out under a warning.
+ *
+ * @param reason Why the function was not decompiled.
+ */
+void Decompiler::PscDecompiler::writeAsmFallback(const std::string &reason)
+{
+    m_FallbackReason = reason;
+    clear();
+    m_LineMap = DebugLineMap();
+    push_back(std::string(WARNING_COMMENT_PREFIX) + " WARNING: Function not decompiled: " + reason);
+    m_CommentAsm = true;
+    decodeToAsm(0, 0, m_Function.getInstructions().size() - 1);
+}
 
+static size_t countSubtree(const Node::Base* node)
+{
+    if (node == nullptr)
+    {
+        return 0;
+    }
+    size_t count = 1;
+    for (auto& child : *node)
+    {
+        count += countSubtree(child.get());
     }
+    return count;
 }
 
 /**
- * @brief Destructor
+ * @brief Count the nodes of the function.
+ * @param program Tree of the function. If null, the nodes of the code blocks are counted.
+ * @return The number of nodes.
  */
-Decompiler::PscDecompiler::~PscDecompiler()
+size_t Decompiler::PscDecompiler::countNodes(const Node::BasePtr &program) const
 {
-    for (auto& bloc_kv : m_CodeBlocs)
+    if (program)
     {
-        auto& bloc = bloc_kv.second;
-        delete bloc;
+        return countSubtree(program.get());
     }
+    size_t count = 0;
+    for (auto& block : m_CodeBlocs)
+    {
+        count += countSubtree(block.second->getScope());
+    }
+    return count;
 }
 
 /**
@@ -168,15 +321,12 @@ void Decompiler::PscDecompiler::decodeToAsm(std::uint8_t level, size_t begin, si
             return;
         }
 
+        LineBuffer stream;
         for (auto ip = begin; ip <= end; ++ip)
         {
             auto& ins = instructions[ip];
-            std::ostringstream stream;
-            for (auto i = 0; i < level; ++i)
-            {
-                stream << ' ' << ' ';
-            }
-            stream << "; " << std::setw(3) << std::setfill('0') << ip << " : " << ins.getOpCodeName() << " ";
+            stream.reset(level);
+            stream << "; " << Pex::Format::pad(ip, 3) << " : " << ins.getOpCodeName() << " ";
             switch(ins.getOpCode())
             {
             case Pex::OpCode::JMP:
@@ -185,7 +335,7 @@ void Decompiler::PscDecompiler::decodeToAsm(std::uint8_t level, size_t begin, si
                 assert(ins.getArgs()[0].getType() == Pex::ValueType::Integer);
 
                 auto target = ip + ins.getArgs()[0].getInteger();
-                stream << std::setw(3) << std::setfill('0') << target;
+                stream << Pex::Format::pad(target, 3);
             }
                 break;
             case Pex::OpCode::JMPF:
@@ -194,9 +344,9 @@ void Decompiler::PscDecompiler::decodeToAsm(std::uint8_t level, size_t begin, si
                 assert(ins.getArgs().size() == 2);
                 assert(ins.getArgs()[1].getType() == Pex::ValueType::Integer);
 
-                stream << ins.getArgs()[0].toString() << " ";
+                stream << ins.getArgs()[0] << " ";
                 auto target = ip + ins.getArgs()[1].getInteger();
-                stream << std::setw(3) << std::setfill('0') << target;
+                stream << Pex::Format::pad(target, 3);
 
             }
                 break;
@@ -204,14 +354,14 @@ void Decompiler::PscDecompiler::decodeToAsm(std::uint8_t level, size_t begin, si
             {
                 for (auto& arg : ins.getArgs())
                 {
-                    stream << arg.toString() << " ";
+                    stream << arg << " ";
                 }
 
                 if (ins.hasVarArgs())
                 {
                     for (auto& arg : ins.getVarArgs())
                     {
-                        stream << arg.toString() << " ";
+                        stream << arg << " ";
                     }
                 }
             }
@@ -228,40 +378,413 @@ void Decompiler::PscDecompiler::decodeToAsm(std::uint8_t level, size_t begin, si
  * @brief Finds the type of the variables.
  *
  * This function finds the type of the local variables and parameters accessible in the function's scope.
- * The types are stored in m_VarTypes.
+ * The types are stored in m_Symbols, the object variables are only collected once per object.
  */
 void Decompiler::PscDecompiler::findVarTypes()
 {
-    for (auto& var : m_Object.getVariables())
-        m_VarTypes[var.getName().asIndex()] = var.getTypeName();
-    for (auto& var : m_Function.getParams())
-        m_VarTypes[var.getName().asIndex()] = var.getTypeName();
-    for (auto& var : m_Function.getLocals())
-        m_VarTypes[var.getName().asIndex()] = var.getTypeName();
-
-    m_NoneVar = m_Object.getName().getTable()->findIdentifier("::nonevar");
+    if (m_Symbols == nullptr)
+    {
+        m_OwnSymbols = std::make_unique<SymbolTable>();
+        m_Symbols = m_OwnSymbols.get();
+    }
+    if (m_Symbols->getObject() != &m_Object)
+    {
+        m_Symbols->setObject(m_Object);
+    }
+    m_Symbols->setFunction(m_Function);
+
+    m_NoneVar = m_Symbols->getNoneVar();
+}
+/**
+ * @brief Decompile a trivial function without building the code blocks and the tree.
+ *
+ * Getters, setters and single calls make a large share of the functions. Their shapes are
+ * recognized on the instructions: a RETURN alone, or an ASSIGN or a CALLMETHOD optionally
+ * followed by a RETURN. The lines are written as the full pipeline writes them, and the
+ * remaining passes are skipped. Other shapes, functions declaring variables and traced
+ * decompilations go through the full pipeline.
+ */
+void Decompiler::PscDecompiler::decompileTrivialFunction()
+{
+    auto& instructions = m_Function.getInstructions();
+    if (m_TraceDecompilation || instructions.size() > 2)
+    {
+        return;
+    }
+    // The lines are those of the cleaned up tree.
+    if (isPassDisabled("cleanUpTree"))
+    {
+        return;
+    }
+    for (auto& local : m_Function.getLocals())
+    {
+        if (!isTempVar(local.getName()))
+        {
+            return;
+        }
+    }
+
+    auto hasReturn = instructions.back().getOpCode() == Pex::OpCode::RETURN;
+    const Pex::Instruction* statement = nullptr;
+    if (instructions.size() == 2 || !hasReturn)
+    {
+        if (instructions.size() == 2 && !hasReturn)
+        {
+            return;
+        }
+        statement = &instructions.front();
+        auto& args = statement->getArgs();
+        if (statement->getOpCode() == Pex::OpCode::ASSIGN)
+        {
+            if (args.size() != 2 || args[0].getType() != Pex::ValueType::Identifier)
+            {
+                return;
+            }
+        }
+        else if (statement->getOpCode() != Pex::OpCode::CALLMETHOD || args.size() != 3
+                 || args[0].getType() != Pex::ValueType::Identifier || args[2].getType() != Pex::ValueType::Identifier)
+        {
+            return;
+        }
+    }
+    const Pex::Value* returned = nullptr;
+    if (hasReturn && !m_ReturnNone)
+    {
+        if (instructions.back().getArgs().size() != 1)
+        {
+            return;
+        }
+        returned = &instructions.back().getArgs()[0];
+    }
+
+    // The result of the statement is assigned if it is a variable, used by the return if it is a
+    // temporary returned, and dropped otherwise.
+    Pex::StringTable::Index result;
+    bool merged = false;
+    if (statement)
+    {
+        auto& args = statement->getArgs();
+        result = statement->getOpCode() == Pex::OpCode::ASSIGN ? args[0].getId() : args[2].getId();
+        if (isTempVar(result))
+        {
+            merged = returned && returned->getType() == Pex::ValueType::Identifier && returned->getId() == result;
+            if (!merged && statement->getOpCode() == Pex::OpCode::ASSIGN)
+            {
+                return;
+            }
+        }
+    }
+
+    m_Trivial = true;
+    commentTempVars();
+    LineBuffer line;
+    auto writeStatement = [&]() {
+        auto& args = statement->getArgs();
+        if (statement->getOpCode() == Pex::OpCode::ASSIGN)
+        {
+            writeTrivialValue(line, args[1]);
+            return;
+        }
+        if (args[1].getType() == Pex::ValueType::Identifier)
+        {
+            line << PscCoder::mapType(getVarName(args[1].getId()));
+        }
+        else
+        {
+            line << args[1];
+        }
+        line << '.' << args[0].getId() << '(';
+        auto first = true;
+        for (auto& arg : statement->getVarArgs())
+        {
+            if (!first)
+            {
+                line << ", ";
+            }
+            first = false;
+            writeTrivialValue(line, arg);
+        }
+        line << ')';
+    };
+
+    if (statement && !merged)
+    {
+        if (!isTempVar(result))
+        {
+            writeTrivialValue(line, Pex::Value(result, true));
+            line << " = ";
+        }
+        writeStatement();
+        writeTrivialLine(line, 0, 0);
+    }
+    if (hasReturn)
+    {
+        auto ip = instructions.size() - 1;
+        line << "Return ";
+        if (merged)
+        {
+            writeStatement();
+            writeTrivialLine(line, 0, ip);
+        }
+        else
+        {
+            if (returned)
+            {
+                writeTrivialValue(line, *returned);
+            }
+            writeTrivialLine(line, ip, ip);
+        }
+    }
 }
 
 /**
- * @brief Get the type of a variable.
- * @param var Name index of the variable.
- * @return The name index of the type.
+ * @brief Add a line of a trivial function.
+ * The line is preceded by its assembly, and mapped to the original lines of its instructions.
+ *
+ * @param line Text of the line, reset for the next line.
+ * @param begin First instruction of the line.
+ * @param end Last instruction of the line.
  */
-const Pex::StringTable::Index& Decompiler::PscDecompiler::typeOfVar(const Pex::StringTable::Index &var) const
+void Decompiler::PscDecompiler::writeTrivialLine(LineBuffer &line, size_t begin, size_t end)
+{
+    decodeToAsm(0, begin, end);
+    std::vector<std::uint16_t> lines;
+    m_LineIndex.getLines(begin, end, lines);
+    push_back(line.str());
+    addLineMapping(size() - 1, lines);
+    line.reset(0);
+}
+
+/**
+ * @brief Write a value of a trivial function, as the code generator writes a constant.
+ * @param line Line receiving the value.
+ * @param value Value to write.
+ */
+void Decompiler::PscDecompiler::writeTrivialValue(LineBuffer &line, const Pex::Value &value) const
 {
-    static const Pex::StringTable::Index UNDEFINED;
-    auto it = m_VarTypes.find(var.asIndex());
-    if (it == m_VarTypes.end())
+    if (value.getType() != Pex::ValueType::Identifier)
     {
-        return UNDEFINED;
+        line << value;
+        return;
+    }
+    auto name = getVarName(value.getId());
+    if (name == "self")
+    {
+        line << "Self";
     }
     else
     {
-        assert(it->second.isValid());
-        return it->second;
+        line << name;
     }
 }
 
+/**
+ * @brief Normalize the compiler patterns of the instructions before the nodes are created.
+ *
+ * The Papyrus compiler computes the expressions through temporaries, most of them read by the
+ * next instruction: the node of such an instruction only lives in the block until
+ * rebuildExpression folds it in the node of its reader, and each fold restarts the scan of the
+ * block. This pass finds the pairs of instructions of a block where the fold can be made when
+ * the nodes are created, the reader receiving the node instead of the temporary. The ::nonevar
+ * results of the calls are dropped when no instruction reads ::nonevar, so rebuildExpression
+ * does not search them in the next statement.
+ *
+ * The trees are those rebuildExpression builds, so the decompiled code is unchanged.
+ * Traced decompilations keep the nodes of all the instructions.
+ */
+void Decompiler::PscDecompiler::normalizeInstructions()
+{
+    if (m_TraceDecompilation)
+    {
+        return;
+    }
+    auto& instructions = m_Function.getInstructions();
+    auto isSplit = [](const Pex::Instruction& ins) {
+        switch (ins.getOpCode())
+        {
+        case Pex::OpCode::JMP:
+        case Pex::OpCode::JMPF:
+        case Pex::OpCode::JMPT:
+        case Pex::OpCode::LOCK_GUARDS:
+        case Pex::OpCode::UNLOCK_GUARDS:
+        case Pex::OpCode::TRY_LOCK_GUARDS:
+            return true;
+        default:
+            return false;
+        }
+    };
+
+    // The jumps and their targets split the blocks, the guards get their own scopes.
+    m_Foldable.assign(instructions.size(), true);
+    if (!instructions.empty())
+    {
+        m_Foldable.back() = false;
+    }
+    for (size_t ip = 0; ip < instructions.size(); ++ip)
+    {
+        auto& ins = instructions[ip];
+        if (!isSplit(ins))
+        {
+            continue;
+        }
+        m_Foldable[ip] = false;
+        if (ip > 0)
+        {
+            m_Foldable[ip - 1] = false;
+        }
+        std::int64_t target = -1;
+        if (ins.getOpCode() == Pex::OpCode::JMP)
+        {
+            target = ip + ins.getArgs()[0].getInteger();
+        }
+        else if (ins.getOpCode() == Pex::OpCode::JMPF || ins.getOpCode() == Pex::OpCode::JMPT)
+        {
+            target = ip + ins.getArgs()[1].getInteger();
+        }
+        if (target > 0 && target <= static_cast<std::int64_t>(instructions.size()))
+        {
+            m_Foldable[target - 1] = false;
+        }
+    }
+
+    // ::nonevar is only written as the result of the calls.
+    m_DropNoneResults = m_NoneVar.isValid();
+    for (size_t ip = 0; ip < instructions.size() && m_DropNoneResults; ++ip)
+    {
+        auto& ins = instructions[ip];
+        auto& args = ins.getArgs();
+        size_t reads = countReads(ins, m_NoneVar);
+        switch (ins.getOpCode())
+        {
+        case Pex::OpCode::CALLMETHOD:
+        case Pex::OpCode::CALLSTATIC:
+            reads -= args[2].getType() == Pex::ValueType::Identifier && args[2].getId() == m_NoneVar;
+            break;
+        case Pex::OpCode::CALLPARENT:
+            reads -= args[1].getType() == Pex::ValueType::Identifier && args[1].getId() == m_NoneVar;
+            break;
+        default:
+            break;
+        }
+        m_DropNoneResults = reads == 0;
+    }
+}
+
+/**
+ * @brief Count the arguments of an instruction naming a variable.
+ * @param instruction Instruction to check.
+ * @param var Name of the variable.
+ * @return The number of arguments, including the variable arguments.
+ */
+size_t Decompiler::PscDecompiler::countReads(const Pex::Instruction &instruction, const Pex::StringTable::Index &var)
+{
+    size_t result = 0;
+    for (auto& arg : instruction.getArgs())
+    {
+        result += arg.getType() == Pex::ValueType::Identifier && arg.getId() == var;
+    }
+    for (auto& arg : instruction.getVarArgs())
+    {
+        result += arg.getType() == Pex::ValueType::Identifier && arg.getId() == var;
+    }
+    return result;
+}
+
+/**
+ * @brief Check if the node of an instruction can be folded in the node of the next instruction.
+ *
+ * The node must compute a temporary read once by the next instruction. The temporaries used
+ * by the node must not be used by the next instruction: rebuildExpression would fold an
+ * earlier node in a different statement.
+ *
+ * @param ip Indice of the instruction.
+ * @param node Node of the instruction.
+ * @param[in,out] temps Temporaries used by the nodes folded in the node, receives those of the node.
+ * @return True if the node can be folded in the next instruction.
+ */
+bool Decompiler::PscDecompiler::canFold(size_t ip, const Node::BasePtr &node, std::vector<Pex::StringTable::Index> &temps) const
+{
+    auto& result = node->getResult();
+    if (ip >= m_Foldable.size() || !m_Foldable[ip] || !result.isValid() || !isTempVar(result))
+    {
+        return false;
+    }
+    auto& instructions = m_Function.getInstructions();
+    if (countReads(instructions[ip + 1], result) != 1 || !addTemps(instructions[ip], result, temps))
+    {
+        return false;
+    }
+    auto size = temps.size();
+    if (!addTemps(instructions[ip + 1], result, temps))
+    {
+        return false;
+    }
+    temps.resize(size);
+    return true;
+}
+
+/**
+ * @brief Add the temporaries read by an instruction.
+ * @param instruction Instruction reading the temporaries.
+ * @param result Temporary to ignore, computed or folded by the instruction.
+ * @param[in,out] temps Temporaries receiving those of the instruction.
+ * @return False if one of the temporaries is already in the list.
+ */
+bool Decompiler::PscDecompiler::addTemps(const Pex::Instruction &instruction, const Pex::StringTable::Index &result,
+                                         std::vector<Pex::StringTable::Index> &temps) const
+{
+    auto add = [&](const Pex::Value& arg) {
+        if (arg.getType() != Pex::ValueType::Identifier || arg.getId() == result || !isTempVar(arg.getId()))
+        {
+            return true;
+        }
+        if (std::find(temps.begin(), temps.end(), arg.getId()) != temps.end())
+        {
+            return false;
+        }
+        temps.push_back(arg.getId());
+        return true;
+    };
+    for (auto& arg : instruction.getArgs())
+    {
+        if (!add(arg))
+        {
+            return false;
+        }
+    }
+    for (auto& arg : instruction.getVarArgs())
+    {
+        if (!add(arg))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Check if an optional pass is disabled.
+ * @param name Name of the pass.
+ * @return True if the pass is skipped.
+ */
+bool Decompiler::PscDecompiler::isPassDisabled(const char *name) const
+{
+    auto& passes = getPasses();
+    for (size_t i = 0; i < passes.size(); ++i)
+    {
+        if (std::strcmp(passes[i].name, name) == 0)
+        {
+            return passes[i].optional && (m_DisabledPasses & (1u << i)) != 0;
+        }
+    }
+    return false;
+}
+
+const Pex::StringTable::Index& Decompiler::PscDecompiler::typeOfVar(const Pex::StringTable::Index &var) const
+{
+    return m_Symbols->typeOf(var);
+}
+
 /**
  * @brief Creates the code blocks graph.
  *
@@ -272,6 +795,20 @@ const Pex::StringTable::Index& Decompiler::PscDecompiler::typeOfVar(const Pex::S
  */
 void Decompiler::PscDecompiler::createFlowBlocks()
 {
+    m_TempTable.push_back("true");
+    m_TempTable.push_back("false");
+
+    m_TempTable.push_back("find");
+    m_TempTable.push_back("findstruct");
+    m_TempTable.push_back("rfind");
+    m_TempTable.push_back("rfindstruct");
+    m_TempTable.push_back("add");
+    m_TempTable.push_back("insert");
+    m_TempTable.push_back("removelast");
+    m_TempTable.push_back("remove");
+    m_TempTable.push_back("clear");
+    m_TempTable.push_back("GetMatchingStructs"); // TODO: VERIFY: Need to verify syntax when CK for Starfield comes out
+
     auto& instructions = m_Function.getInstructions();
     auto full = new PscCodeBlock(0, instructions.size() - 1);
     full->setNext(instructions.size());
@@ -282,6 +819,7 @@ void Decompiler::PscDecompiler::createFlowBlocks()
     auto ip = 0;
     for (auto& ins : instructions)
     {
+        checkLimits();
         auto block = findBlockForInstruction(ip);
         switch(ins.getOpCode())
         {
@@ -311,6 +849,7 @@ void Decompiler::PscDecompiler::createFlowBlocks()
             // Split the block at the jump and set the next block to the target of the jump.
             if (m_CodeBlocs.find(ip+1) == m_CodeBlocs.end())
             {
+                record(FlightRecorder::Event::Split, "next", block, ip+1);
                 auto newBlock = m_CodeBlocs[block]->split(ip+1);
                 m_CodeBlocs[newBlock->getBegin()] = newBlock;
 
@@ -320,6 +859,7 @@ void Decompiler::PscDecompiler::createFlowBlocks()
             if (m_CodeBlocs.find(target) == m_CodeBlocs.end())
             {
                 auto containingBlock = m_CodeBlocs[findBlockForInstruction(target)];
+                record(FlightRecorder::Event::Split, "target", containingBlock->getBegin(), target);
                 auto targetBlock = containingBlock->split(target);
                 m_CodeBlocs[targetBlock->getBegin()] = targetBlock;
             }
@@ -342,6 +882,7 @@ void Decompiler::PscDecompiler::createFlowBlocks()
             auto target = ip + ins.getArgs()[1].getInteger();
             if (m_CodeBlocs.find(ip+1) == m_CodeBlocs.end())
             {
+                record(FlightRecorder::Event::Split, "next", block, ip+1);
                 auto newBlock = m_CodeBlocs[block]->split(ip+1);
                 m_CodeBlocs[newBlock->getBegin()] = newBlock;
             }
@@ -349,6 +890,7 @@ void Decompiler::PscDecompiler::createFlowBlocks()
             if (m_CodeBlocs.find(target) == m_CodeBlocs.end())
             {
                 auto containingBlock = m_CodeBlocs[findBlockForInstruction(target)];
+                record(FlightRecorder::Event::Split, "target", containingBlock->getBegin(), target);
                 auto targetBlock = containingBlock->split(target);
                 m_CodeBlocs[targetBlock->getBegin()] = targetBlock;
             }
@@ -412,6 +954,8 @@ void Decompiler::PscDecompiler::createNodesForBlocks(size_t block)
     auto scope = code->getScope();
     if (code->getBegin() < instructions.size())
     {
+        // Temporaries used in the node folded in the next instruction
+        std::vector<Pex::StringTable::Index> temps;
         for(auto ip = code->getBegin(); ip <= code->getEnd(); ++ip)
         {
             auto& ins = instructions[ip];
@@ -742,11 +1286,35 @@ void Decompiler::PscDecompiler::createNodesForBlocks(size_t block)
                     throw std::exception("Unsupported opcode");
                 }
             }
+            if (m_Folded)
+            {
+                // The instruction did not read the folded node, which stays a statement
+                *scope << checkAssign(m_Folded);
+                m_Folded = nullptr;
+                temps.clear();
+            }
             if (node)
-            {                
-                *scope << checkAssign(node);
+            {
+                if (m_DropNoneResults && node->getResult() == m_NoneVar)
+                {
+                    node->clearResult();
+                }
+                if (canFold(ip, node, temps))
+                {
+                    m_Folded = node;
+                }
+                else
+                {
+                    *scope << checkAssign(node);
+                    temps.clear();
+                }
             }
         }
+        if (m_Folded)
+        {
+            *scope << checkAssign(m_Folded);
+            m_Folded = nullptr;
+        }
     }
 }
 
@@ -789,13 +1357,20 @@ void Decompiler::PscDecompiler::rebuildExpressionsInBlocks()
  * The statements are reconstructed by propagating the first node
  * where the result computed by this node is used in the following
  * instructions.
+ *
+ * Folding a node only changes the next one, so the scan resumes at the node preceding the
+ * folded one: the nodes before it were already checked and cannot fold anymore.
+ *
  * @param scope Scope which will receive the nodes.
+ * @param first Indice of the first node to check, the nodes before it being already rebuilt.
  */
-void Decompiler::PscDecompiler::rebuildExpression(Node::BasePtr scope)
+void Decompiler::PscDecompiler::rebuildExpression(Node::BasePtr scope, size_t first)
 {
-    auto it = scope->begin();
+    auto it = scope->begin() + std::min(first, scope->size());
     while (it != scope->end())
     {
+        checkLimits();
+        auto position = std::distance(scope->begin(), it);
         auto nextIt = std::next(it);
         auto expressionGeneration = *it;
         if (! expressionGeneration->isFinal() && nextIt != scope->end())
@@ -821,7 +1396,7 @@ void Decompiler::PscDecompiler::rebuildExpression(Node::BasePtr scope)
             }
             else if (modified == 1)
             {
-                it = scope->begin();
+                it = scope->begin() + (position > 0 ? position - 1 : 0);
             }
             else
             {
@@ -848,20 +1423,24 @@ void Decompiler::PscDecompiler::rebuildExpression(Node::BasePtr scope)
  */
 void Decompiler::PscDecompiler::rebuildBooleanOperators(size_t startBlock, size_t endBlock)
 {
-    bool debugSigil = false;
-    if (m_Function.getName().isValid() && m_Function.getName().asString() == "OnTrackedStatsEvent"){
-        debugSigil = true;
-    }
+    record(FlightRecorder::Event::Boolean, nullptr, startBlock, endBlock);
+    DepthGuard depth(m_Depth);
+    // The nested ranges are part of the range dumped by the outermost call
+    auto outermost = m_BooleanDepth++ == 0;
     if (m_TraceDecompilation)
     {
         m_Log << "--- BEGIN REBUILD : " << startBlock << " " << endBlock << std::endl;
-        dumpBlock(startBlock, endBlock);
+        if (outermost)
+        {
+            dumpBlock(startBlock, endBlock);
+        }
     }
     auto begin = m_CodeBlocs.find(startBlock);
     auto end = m_CodeBlocs.find(endBlock);
     auto it = begin;
     while (it != end)
     {
+        checkLimits();
         auto& source = it->second;
         int advance = 1;
         bool parentIsAssign = false;
@@ -914,19 +1493,18 @@ void Decompiler::PscDecompiler::rebuildBooleanOperators(size_t startBlock, size_
                 assert(!(maybeAnd && maybeOr));
 
                 auto next = maybeAnd ? source->onTrue() : source->onFalse();
-                auto jumpnext = maybeAnd ? source->onFalse() : source->onTrue();
 
               // check debug info
 
 
                 if (!m_DebugInfo.getLineNumbers().empty() && m_CodeBlocs[next]->getEnd() != PscCodeBlock::END){
                   auto nextBlock = m_CodeBlocs[next];
-                  auto jumpBlock = m_CodeBlocs[jumpnext];
                   auto srcNode = source->getScope()->back();
-                  auto sourceLines = m_DebugInfo.getLineNumbersForIpRange(srcNode->getBegin(), srcNode->getEnd());
+                  std::vector<uint16_t> sourceLines;
+                  m_LineIndex.getLines(srcNode->getBegin(), srcNode->getEnd(), sourceLines);
                   auto nextNode = nextBlock->getScope()->size() > 0 ? nextBlock->getScope()->front() : nextBlock->getScope()->shared_from_this();
-                  auto nextLines = m_DebugInfo.getLineNumbersForIpRange(nextNode->getBegin(), nextNode->getEnd());
-                  auto jumpLines = m_DebugInfo.getLineNumbersForIpRange(jumpBlock->getBegin(), jumpBlock->getEnd());
+                  std::vector<uint16_t> nextLines;
+                  m_LineIndex.getLines(nextNode->getBegin(), nextNode->getEnd(), nextLines);
 
                   // If the last source line is the same as the first next line, it is a potential and/or
                   // otherwise, don't attempt to squeeze these together.
@@ -1006,12 +1584,15 @@ void Decompiler::PscDecompiler::rebuildBooleanOperators(size_t startBlock, size_
                             } else {
                                 *(source->getScope()) << andOperator;
                             }
+                            record(FlightRecorder::Event::And, nullptr, source->getBegin(), onTrue->getBegin());
                             // Remove the true block now that the expression is rebuild
                             m_CodeBlocs.erase(onTrue->getBegin());
 
                             // Merge the false block.
+                            // Only the operator and the merged statements may fold, the statements before are already rebuilt.
+                            auto rebuilt = source->getScope()->size();
                             source->getScope()->mergeChildren(onFalse->getScope()->shared_from_this());
-                            rebuildExpression(source->getScope()->shared_from_this());
+                            rebuildExpression(source->getScope()->shared_from_this(), rebuilt > 1 ? rebuilt - 2 : 0);
                             if(onFalse->getEnd() != PscCodeBlock::END){
                                 source->setEnd(onFalse->getEnd());
                                 source->setCondition(onFalse->getCondition(), onFalse->onTrue(), onFalse->onFalse());
@@ -1093,12 +1674,14 @@ void Decompiler::PscDecompiler::rebuildBooleanOperators(size_t startBlock, size_
                             *(source->getScope()) << orOperator;
                         }
 
+                        record(FlightRecorder::Event::Or, nullptr, source->getBegin(), onFalse->getBegin());
                         //Remove the false block now that the expression is rebuild
                         m_CodeBlocs.erase(onFalse->getBegin());
 
                         //Merge the true block.
+                        auto rebuilt = source->getScope()->size();
                         source->getScope()->mergeChildren(onTrue->getScope()->shared_from_this());
-                        rebuildExpression(source->getScope()->shared_from_this());
+                        rebuildExpression(source->getScope()->shared_from_this(), rebuilt > 1 ? rebuilt - 2 : 0);
                         if (onTrue->getEnd() != PscCodeBlock::END){
                             source->setEnd(onTrue->getEnd());
                             source->setCondition(onTrue->getCondition(), onTrue->onTrue(), onTrue->onFalse());
@@ -1131,10 +1714,14 @@ void Decompiler::PscDecompiler::rebuildBooleanOperators(size_t startBlock, size_
         }
         std::advance(it, advance);
     }
+    --m_BooleanDepth;
     if (m_TraceDecompilation)
     {
         m_Log << "--- END REBUILD : " << startBlock << " " << endBlock << std::endl;
-        dumpBlock(startBlock, endBlock);
+        if (outermost)
+        {
+            dumpBlock(startBlock, endBlock);
+        }
     }
 }
 
@@ -1150,6 +1737,8 @@ void Decompiler::PscDecompiler::rebuildBooleanOperators(size_t startBlock, size_
  */
 Node::BasePtr Decompiler::PscDecompiler::rebuildControlFlow(size_t startBlock, size_t endBlock)
 {
+    record(FlightRecorder::Event::Flow, nullptr, startBlock, endBlock);
+    DepthGuard depth(m_Depth);
     if (endBlock < startBlock)
     {
       auto funcname = m_Function.getName().isValid() ? m_Function.getName().asString() : "unknown function";
@@ -1162,6 +1751,7 @@ Node::BasePtr Decompiler::PscDecompiler::rebuildControlFlow(size_t startBlock, s
     Node::BasePtr result = std::make_shared<Node::Scope>();
     while (it != end)
     {
+        checkLimits();
         auto current = it->first;
         auto& source = it->second;
         int advance = 1;
@@ -1198,6 +1788,7 @@ Node::BasePtr Decompiler::PscDecompiler::rebuildControlFlow(size_t startBlock, s
                 // while loop
                 auto whileStartBlock = source->onTrue();
                 auto whileEndBlock = source->onFalse();
+                record(FlightRecorder::Event::While, nullptr, whileStartBlock, whileEndBlock);
 
                 result->mergeChildren(source->getScope()->shared_from_this());
 
@@ -1218,6 +1809,7 @@ Node::BasePtr Decompiler::PscDecompiler::rebuildControlFlow(size_t startBlock, s
                     // Simple If
                     auto ifStartBlock = source->onTrue();
                     auto ifEndBlock = source->onFalse();
+                    record(FlightRecorder::Event::If, nullptr, ifStartBlock, ifEndBlock);
 
                     result->mergeChildren(source->getScope()->shared_from_this());
 
@@ -1234,6 +1826,7 @@ Node::BasePtr Decompiler::PscDecompiler::rebuildControlFlow(size_t startBlock, s
                     auto ifStartBlock = source->onTrue();
                     auto elseStartBlock = source->onFalse();
                     auto endElseBlock = lastBlock->getNext();
+                    record(FlightRecorder::Event::IfElse, nullptr, ifStartBlock, endElseBlock);
 
 
                     result->mergeChildren(source->getScope()->shared_from_this());
@@ -1383,6 +1976,7 @@ void Decompiler::PscDecompiler::declareVariables(Node::BasePtr program)
             {
                 // Declare at the top of the scope
                 scope->push_front(declare);
+                scope->invalidateHash();
             }
         }
     }
@@ -1576,6 +2170,7 @@ void Decompiler::PscDecompiler::rebuildLocks(Node::BasePtr &program) {
                 return true;
             }).from(program);
     for (auto nodeptr: lockNodes){
+        checkLimits();
         LiftLockBody(nodeptr);
     }
 
@@ -1696,6 +2291,17 @@ void Decompiler::PscDecompiler::generateCode(Node::BasePtr program)
         program->visit(&tree);
     }
 
+    commentTempVars();
+
+    PscCodeGenerator codegen(this);
+    program->visit(&codegen);
+}
+
+/**
+ * @brief Output the temporary variables as comments, when the assembly is commented.
+ */
+void Decompiler::PscDecompiler::commentTempVars()
+{
     if (m_CommentAsm)
     {
         for (auto& local : m_Function.getLocals())
@@ -1709,9 +2315,6 @@ void Decompiler::PscDecompiler::generateCode(Node::BasePtr program)
         }
         push_back("");
     }
-
-    PscCodeGenerator codegen(this);
-    program->visit(&codegen);
 }
 
 /**
@@ -1727,12 +2330,20 @@ Pex::StringTable::Index Decompiler::PscDecompiler::toIdentifier(const Pex::Value
 
 /**
  * @brief Create a tree node from a value.
+ * The temporary computed by a node folded by normalizeInstructions is replaced by the node.
+ *
  * @param ip Indice of the instruction using the value.
  * @param value Value used as constant.
  * @return The constant node.
  */
-Node::BasePtr Decompiler::PscDecompiler::fromValue(size_t ip, const Pex::Value &value) const
+Node::BasePtr Decompiler::PscDecompiler::fromValue(size_t ip, const Pex::Value &value)
 {
+    if (m_Folded && value.getType() == Pex::ValueType::Identifier && value.getId() == m_Folded->getResult())
+    {
+        Node::BasePtr folded;
+        folded.swap(m_Folded);
+        return folded;
+    }
     return std::make_shared<Node::Constant>(ip, value);
 }
 
@@ -1796,13 +2407,37 @@ void Decompiler::PscDecompiler::dumpBlock(size_t startBlock, size_t endBlock)
     }
 }
 
+/**
+ * @brief Record a decompilation event in the flight recorder, if any.
+ * @param event Kind of event.
+ * @param label Static description of the event.
+ * @param first First operand of the event.
+ * @param second Second operand of the event.
+ */
+void Decompiler::PscDecompiler::record(FlightRecorder::Event event, const char *label, size_t first, size_t second)
+{
+    if (m_Recorder)
+    {
+        m_Recorder->record(event, label, first, second);
+    }
+}
+
 bool Decompiler::PscDecompiler::isDebugFunction() {
+    return isDebugFunction(*this);
+}
+
+/**
+ * @brief Check if decompiled lines read debug only variables.
+ * @param lines Decompiled lines of a function.
+ * @return True if a line uses a ::temp variable outside of a comment.
+ */
+bool Decompiler::PscDecompiler::isDebugFunction(const std::vector<std::string> &lines) {
     // TODO: Actually walk the tree instead of doing dump string comparisons
     // We need to check if there are still ::temp variables in the tree.
     // If there are, then this indicates that this read from debug variables that
     // were not actually initialized because they were marked DebugOnly
     // and weren't properly poisoned by the Papyrus debugger.
-    for (auto& line : *this) {
+    for (auto& line : lines) {
         int64_t i = line.find("::temp");
         int64_t comment = line.find(";");
         if (i != std::string::npos && (comment == std::string::npos || i < comment)) {
@@ -1816,10 +2451,65 @@ const Pex::DebugInfo::FunctionInfo & Decompiler::PscDecompiler::getDebugInfo() {
     return m_DebugInfo;
 }
 
-void Decompiler::PscDecompiler::addLineMapping(size_t decompiledLine, std::vector<uint16_t> &originalLines) {
-    m_LineMap[decompiledLine] = std::move(originalLines);
+const Pex::DebugInfo::LineIndex & Decompiler::PscDecompiler::getLineIndex() const {
+    return m_LineIndex;
+}
+
+void Decompiler::PscDecompiler::addLineMapping(size_t decompiledLine, const std::vector<uint16_t> &originalLines) {
+    m_LineMap.add(decompiledLine, originalLines);
 }
 
-Decompiler::PscDecompiler::DebugLineMap &Decompiler::PscDecompiler::getLineMap() {
+const Decompiler::PscDecompiler::DebugLineMap &Decompiler::PscDecompiler::getLineMap() const {
   return m_LineMap;
 }
+
+/**
+ * @brief Get why the function was written as assembly.
+ * @return The reason, empty if the function was decompiled.
+ */
+const std::string &Decompiler::PscDecompiler::getFallbackReason() const
+{
+    return m_FallbackReason;
+}
+
+/**
+ * @brief Set the original lines of a decompiled line.
+ * The decompiled lines must be added in increasing order, the lines skipped have no original lines.
+ *
+ * @param decompiledLine Index of the decompiled line.
+ * @param originalLines Original lines of the decompiled line.
+ */
+void Decompiler::PscDecompiler::DebugLineMap::add(size_t decompiledLine, const std::vector<std::uint16_t> &originalLines)
+{
+    assert(decompiledLine + 1 >= m_Offsets.size());
+    m_Offsets.resize(decompiledLine + 1, static_cast<std::uint32_t>(m_Lines.size()));
+    m_Lines.insert(m_Lines.end(), originalLines.begin(), originalLines.end());
+    m_Offsets.push_back(static_cast<std::uint32_t>(m_Lines.size()));
+}
+
+/**
+ * @brief Get the original lines of a decompiled line.
+ * @param decompiledLine Index of the decompiled line.
+ * @return The range of the original lines, empty if the line has no original line.
+ */
+std::pair<Decompiler::PscDecompiler::DebugLineMap::const_iterator, Decompiler::PscDecompiler::DebugLineMap::const_iterator>
+Decompiler::PscDecompiler::DebugLineMap::get(size_t decompiledLine) const
+{
+    if (decompiledLine + 1 >= m_Offsets.size())
+    {
+        return {m_Lines.end(), m_Lines.end()};
+    }
+    return {m_Lines.begin() + m_Offsets[decompiledLine], m_Lines.begin() + m_Offsets[decompiledLine + 1]};
+}
+
+/**
+ * @brief Move all the original lines by the same amount.
+ * @param delta Number of lines to add, wrapping around as the debug line numbers.
+ */
+void Decompiler::PscDecompiler::DebugLineMap::shift(std::int32_t delta)
+{
+    for (auto& line : m_Lines)
+    {
+        line = static_cast<std::uint16_t>(line + delta);
+    }
+}
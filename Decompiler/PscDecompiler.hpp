@@ -1,13 +1,20 @@
 #pragma once
 
+#include <chrono>
 #include <vector>
 #include <string>
-#include <fstream>
+#include <ostream>
+#include <utility>
 
 #include <map>
+#include <memory>
 
 #include "Pex/Object.hpp"
 #include "PscCodeBlock.hpp"
+#include "FlightRecorder.hpp"
+#include "LineBuffer.hpp"
+#include "PassProfile.hpp"
+#include "SymbolTable.hpp"
 
 #include "Node/Base.hpp"
 #include "Pex/DebugInfo.hpp"
@@ -24,22 +31,77 @@ class PscDecompiler :
         public std::vector<std::string>
 {
 public:
-    typedef std::map<size_t, std::vector<uint16_t>> DebugLineMap;
+    /**
+     * @brief Original lines of each decompiled line.
+     * The original lines are stored contiguously, in the order of the decompiled lines.
+     */
+    class DebugLineMap
+    {
+    public:
+        typedef std::vector<std::uint16_t>::const_iterator const_iterator;
+
+        void add(size_t decompiledLine, const std::vector<std::uint16_t>& originalLines);
+        std::pair<const_iterator, const_iterator> get(size_t decompiledLine) const;
+        void shift(std::int32_t delta);
+
+    protected:
+        friend class FunctionCache;
+
+        std::vector<std::uint16_t> m_Lines;
+        // Position in m_Lines of the original lines of each decompiled line, followed by the end position.
+        std::vector<std::uint32_t> m_Offsets{0};
+    };
+
+    /**
+     * @brief Limits of the decompilation of a function, zero meaning no limit.
+     * A function exceeding a limit, or failing to decompile, is written as commented assembly.
+     */
+    struct Limits
+    {
+        std::chrono::milliseconds time{0};
+        size_t nodes = 0;
+        size_t depth = 0;
+    };
 
     PscDecompiler(const Pex::Function &function, const Pex::Object &object,
                   const Pex::DebugInfo::FunctionInfo *debugInfo, bool commentAsm, bool traceDecompilation,
-                  bool dumpTree, std::string outputDir);
+                  bool dumpTree, std::ostream *traceLog, FlightRecorder *recorder, SymbolTable *symbols,
+                  PassProfile *profile, std::uint32_t disabledPasses, const Limits *limits);
     ~PscDecompiler();
 
+    /**
+     * @brief Decompilation pass.
+     * The passes run in order; an optional pass can be disabled.
+     */
+    struct Pass
+    {
+        const char* name;
+        bool optional;
+        void (*run)(PscDecompiler& decompiler, Node::BasePtr& program);
+    };
+    static const std::vector<Pass>& getPasses();
+
     void decodeToAsm(std::uint8_t level, size_t begin, size_t end);
     bool isDebugFunction();
+    static bool isDebugFunction(const std::vector<std::string>& lines);
     const Pex::DebugInfo::FunctionInfo & getDebugInfo();
-    void addLineMapping(size_t decompiledLine, std::vector<uint16_t> &originalLines);
-    DebugLineMap &getLineMap();
+    const Pex::DebugInfo::LineIndex & getLineIndex() const;
+    void addLineMapping(size_t decompiledLine, const std::vector<uint16_t> &originalLines);
+    const DebugLineMap &getLineMap() const;
+    const std::string &getFallbackReason() const;
 protected:
 
 
     void findVarTypes();
+    void decompileTrivialFunction();
+    void writeTrivialLine(LineBuffer& line, size_t begin, size_t end);
+    void writeTrivialValue(LineBuffer& line, const Pex::Value& value) const;
+    void normalizeInstructions();
+    static size_t countReads(const Pex::Instruction& instruction, const Pex::StringTable::Index& var);
+    bool canFold(size_t ip, const Node::BasePtr& node, std::vector<Pex::StringTable::Index>& temps) const;
+    bool addTemps(const Pex::Instruction& instruction, const Pex::StringTable::Index& result,
+                  std::vector<Pex::StringTable::Index>& temps) const;
+    bool isPassDisabled(const char* name) const;
     const Pex::StringTable::Index& typeOfVar(const Pex::StringTable::Index& var) const;
     void createFlowBlocks();
 
@@ -48,7 +110,7 @@ protected:
 
 
     void rebuildExpressionsInBlocks();
-    void rebuildExpression(Node::BasePtr scope);
+    void rebuildExpression(Node::BasePtr scope, size_t first = 0);
 
     void rebuildBooleanOperators(size_t startBlock, size_t endBlock);
     Node::BasePtr rebuildControlFlow(size_t startBlock, size_t endBlock);
@@ -59,35 +121,58 @@ protected:
     void cleanUpTree(Node::BasePtr program);
 
     void generateCode(Node::BasePtr program);
+    void commentTempVars();
     Pex::StringTable::Index toIdentifier(const Pex::Value& value) const;
-    Node::BasePtr fromValue(size_t ip, const Pex::Value& value) const;
+    Node::BasePtr fromValue(size_t ip, const Pex::Value& value);
     Node::BasePtr checkAssign(Node::BasePtr expression) const;
 
+    void runPass(const Pass& pass, Node::BasePtr& program);
+    void checkLimits() const;
+    void writeAsmFallback(const std::string& reason);
+    size_t countNodes(const Node::BasePtr& program) const;
+
     void dumpBlock(size_t startBlock, size_t endBlock);
+    void record(FlightRecorder::Event event, const char* label, size_t first = 0, size_t second = 0);
 protected:
     typedef std::map<size_t, PscCodeBlock*> CodeBlocs;
     CodeBlocs m_CodeBlocs;
 
-    typedef std::map<std::uint16_t, Pex::StringTable::Index> VarToProperties;
-    VarToProperties m_VarToProperties;
-
-    typedef std::map<std::uint16_t, Pex::StringTable::Index> VarTypes;
-    VarTypes m_VarTypes;
+    SymbolTable* m_Symbols;
+    std::unique_ptr<SymbolTable> m_OwnSymbols;
 
     Pex::StringTable::Index m_NoneVar;
 
     const Pex::Function& m_Function;
     const Pex::Object&   m_Object;
     bool m_ReturnNone;
+    bool m_Trivial;
 
     bool m_CommentAsm;
     bool m_TraceDecompilation;
     bool m_DumpTree;
     const Pex::DebugInfo::FunctionInfo m_DebugInfo;
-    std::string m_OutputDir;
-    std::ofstream m_Log;
+    const Pex::DebugInfo::LineIndex m_LineIndex;
+    std::ostream m_Log;
+    FlightRecorder* m_Recorder;
+    PassProfile* m_Profile;
+    std::uint32_t m_DisabledPasses;
     Pex::StringTable m_TempTable;
 
+    // Instructions whose node may be folded in the node of the next instruction, see normalizeInstructions
+    std::vector<bool> m_Foldable;
+    // Node folded in the node being created
+    Node::BasePtr m_Folded;
+    bool m_DropNoneResults;
+    // Nesting of rebuildBooleanOperators
+    size_t m_BooleanDepth;
+
+    const Limits* m_Limits;
+    std::chrono::steady_clock::time_point m_Start;
+    // Nesting of rebuildControlFlow and rebuildBooleanOperators, checked against the depth limit
+    size_t m_Depth;
+    // Why the function is written as assembly, empty if it was decompiled
+    std::string m_FallbackReason;
+
     // Map of decompiled lines to the range of (potentially multiple) original lines that were in the debug info
     DebugLineMap m_LineMap;
 
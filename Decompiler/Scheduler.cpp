@@ -0,0 +1,201 @@
+#include "Scheduler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "FileWriter.hpp"
+
+/**
+ * @brief Default constructor
+ */
+Decompiler::Scheduler::Scheduler()
+{
+}
+
+/**
+ * @brief Read the times of the files from the timing log of a previous run.
+ * Each line of the log is the time of a file in microseconds, a tab and the absolute path of the file.
+ * A missing log is ignored.
+ *
+ * @param path Path of the timing log.
+ */
+void Decompiler::Scheduler::loadTimes(const std::string &path)
+{
+    std::ifstream stream(path);
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        auto tab = line.find('\t');
+        if (tab == std::string::npos)
+        {
+            continue;
+        }
+        std::istringstream time(line.substr(0, tab));
+        std::uint64_t microseconds;
+        if (time >> microseconds)
+        {
+            m_Times[line.substr(tab + 1)] = microseconds;
+        }
+    }
+}
+
+/**
+ * @brief Write the timing log.
+ * The files of this run are written with their new time, the other files of the loaded log are kept.
+ *
+ * @param path Path of the timing log.
+ */
+void Decompiler::Scheduler::saveTimes(const std::string &path) const
+{
+    auto times = m_Times;
+    for (size_t i = 0; i < m_Keys.size(); ++i)
+    {
+        if (m_Measured[i].count() != 0)
+        {
+            times[m_Keys[i]] = std::chrono::duration_cast<std::chrono::microseconds>(m_Measured[i]).count();
+        }
+    }
+    std::vector<std::pair<std::string, std::uint64_t>> sorted(times.begin(), times.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    std::string content;
+    for (auto& entry : sorted)
+    {
+        content += std::to_string(entry.second) + '\t' + entry.first + '\n';
+    }
+    FileWriter writer(path);
+    writer.writeContent(content);
+    writer.commit();
+}
+
+/**
+ * @brief Add a file to the run.
+ * @param file Path of the file. An unreadable file has a null cost, its error is left to the processing.
+ */
+void Decompiler::Scheduler::add(const std::filesystem::path &file)
+{
+    std::error_code error;
+    auto size = std::filesystem::file_size(file, error);
+    m_Keys.push_back(getKey(file));
+    m_Sizes.push_back(error ? 0 : static_cast<std::uint64_t>(size));
+    m_Measured.emplace_back();
+}
+
+/**
+ * @brief Process the files with a pool of workers.
+ * The function returns once all the files are processed. The calling thread is one of the workers.
+ *
+ * @param workers Number of workers.
+ * @param process Function processing a file, called with the index of the file in the order of add.
+ */
+void Decompiler::Scheduler::run(size_t workers, const std::function<void(size_t)> &process)
+{
+    workers = std::max<size_t>(workers, 1);
+    auto tasks = makeTasks(workers);
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        for (auto t = next++; t < tasks.size(); t = next++)
+        {
+            for (auto file : tasks[t].files)
+            {
+                auto start = std::chrono::steady_clock::now();
+                process(file);
+                m_Measured[file] = std::chrono::steady_clock::now() - start;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(workers, tasks.size()); ++i)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Group the files in tasks, sorted by decreasing cost.
+ *
+ * The files costing more than a batch are tasks of their own. The other files are packed, from
+ * the most expensive down, in batches costing at most a TASKS_PER_WORKER-th of the share of a
+ * worker, small enough for the last tasks not to delay the end of the run.
+ *
+ * @param workers Number of workers.
+ * @return The tasks, in the order they are dispatched.
+ */
+std::vector<Decompiler::Scheduler::Task> Decompiler::Scheduler::makeTasks(size_t workers) const
+{
+    // The files missing from the log cost their size at the average time per byte of the others
+    double knownTime = 0;
+    double knownSize = 0;
+    for (size_t i = 0; i < m_Keys.size(); ++i)
+    {
+        auto time = m_Times.find(m_Keys[i]);
+        if (time != m_Times.end())
+        {
+            knownTime += time->second;
+            knownSize += m_Sizes[i];
+        }
+    }
+    auto perByte = knownTime > 0 && knownSize > 0 ? knownTime / knownSize : 1.0;
+
+    std::vector<double> costs(m_Keys.size());
+    std::vector<size_t> order(m_Keys.size());
+    double total = 0;
+    for (size_t i = 0; i < m_Keys.size(); ++i)
+    {
+        auto time = m_Times.find(m_Keys[i]);
+        costs[i] = time != m_Times.end() ? time->second : m_Sizes[i] * perByte;
+        order[i] = i;
+        total += costs[i];
+    }
+    std::stable_sort(order.begin(), order.end(), [&costs](size_t left, size_t right) {
+        return costs[left] > costs[right];
+    });
+
+    auto batchCost = total / (workers * TASKS_PER_WORKER);
+    std::vector<Task> tasks;
+    Task batch{{}, 0};
+    for (auto i : order)
+    {
+        if (costs[i] >= batchCost)
+        {
+            tasks.push_back(Task{{i}, costs[i]});
+            continue;
+        }
+        if (!batch.files.empty() && batch.cost + costs[i] > batchCost)
+        {
+            tasks.push_back(std::move(batch));
+            batch = Task{{}, 0};
+        }
+        batch.files.push_back(i);
+        batch.cost += costs[i];
+    }
+    if (!batch.files.empty())
+    {
+        tasks.push_back(std::move(batch));
+    }
+    std::stable_sort(tasks.begin(), tasks.end(), [](const Task& left, const Task& right) {
+        return left.cost > right.cost;
+    });
+    return tasks;
+}
+
+/**
+ * @brief Get the key of a file in the timing log.
+ * @param file Path of the file.
+ * @return The absolute path, so the log does not depend on the working directory.
+ */
+std::string Decompiler::Scheduler::getKey(const std::filesystem::path &file)
+{
+    std::error_code error;
+    auto absolute = std::filesystem::absolute(file, error);
+    return (error ? file : absolute).lexically_normal().generic_string();
+}
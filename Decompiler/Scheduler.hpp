@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Decompiler {
+
+/**
+ * @brief Order the files of a parallel run so the workers finish together.
+ *
+ * The cost of a file is its size, or its time in a previous run when a timing log is loaded.
+ * The files are dispatched from the most expensive down, so a huge script never starts last
+ * while the other workers are idle, and the cheap files are grouped in batches to save the
+ * overhead of a task per file.
+ */
+class Scheduler
+{
+public:
+    // Lower bound of the number of tasks per worker, the cheap files are batched up to this granularity
+    static const size_t TASKS_PER_WORKER = 16;
+
+    Scheduler();
+
+    void loadTimes(const std::string& path);
+    void saveTimes(const std::string& path) const;
+
+    void add(const std::filesystem::path& file);
+    void run(size_t workers, const std::function<void(size_t)>& process);
+
+protected:
+    struct Task
+    {
+        // Files of the task, indices in the order of add
+        std::vector<size_t> files;
+        double cost;
+    };
+
+    std::vector<Task> makeTasks(size_t workers) const;
+    static std::string getKey(const std::filesystem::path& file);
+
+    std::vector<std::string> m_Keys;
+    std::vector<std::uint64_t> m_Sizes;
+    // Time of each file in microseconds, from the timing log
+    std::unordered_map<std::string, std::uint64_t> m_Times;
+    // Time of each file of this run, zero if not processed
+    std::vector<std::chrono::steady_clock::duration> m_Measured;
+};
+
+}
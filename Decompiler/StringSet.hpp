@@ -0,0 +1,229 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace Decompiler {
+
+namespace Detail {
+
+constexpr char toLowerAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+constexpr bool equalsNoCase(std::string_view left, std::string_view right)
+{
+    if (left.size() != right.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < left.size(); ++i)
+    {
+        if (toLowerAscii(left[i]) != toLowerAscii(right[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// FNV-1a on the lower case characters.
+constexpr std::uint32_t hashNoCase(std::string_view value)
+{
+    std::uint32_t hash = 2166136261u;
+    for (auto c : value)
+    {
+        hash ^= static_cast<std::uint8_t>(toLowerAscii(c));
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+constexpr std::uint32_t mixHash(std::uint32_t hash, std::uint32_t seed)
+{
+    auto x = hash ^ (seed * 0x9E3779B9u);
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    x ^= x >> 16;
+    return x;
+}
+
+constexpr size_t nextPowerOfTwo(size_t value)
+{
+    size_t result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+}
+
+/**
+ * @brief Compile time perfect hash set of ASCII strings, with case insensitive lookup.
+ *
+ * The table is built with the hash and displace method: the keys are grouped in buckets by
+ * their hash, then each bucket receives the seed which places all its keys in free slots.
+ * A lookup hashes the key once and compares it with a single slot, without allocation.
+ * Duplicated keys are allowed and stored once.
+ */
+template <size_t N>
+class StringSet
+{
+public:
+    static constexpr size_t SLOTS = Detail::nextPowerOfTwo(2 * N);
+    static constexpr size_t BUCKETS = Detail::nextPowerOfTwo(N / 2 + 1);
+
+    constexpr StringSet() :
+        m_Slots{},
+        m_Seeds{}
+    {
+        clear();
+    }
+
+    template <size_t M>
+    constexpr explicit StringSet(const std::string_view (&keys)[M]) :
+        m_Slots{},
+        m_Seeds{}
+    {
+        static_assert(M == N, "StringSet: wrong number of keys");
+        clear();
+
+        // Sort the keys by bucket.
+        std::array<std::uint32_t, N> hashes{};
+        std::array<size_t, BUCKETS + 1> start{};
+        std::array<size_t, BUCKETS> filled{};
+        std::array<size_t, N> order{};
+        for (size_t i = 0; i < N; ++i)
+        {
+            hashes[i] = Detail::hashNoCase(keys[i]);
+            ++start[bucketOf(hashes[i]) + 1];
+        }
+        for (size_t b = 0; b < BUCKETS; ++b)
+        {
+            start[b + 1] += start[b];
+        }
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto b = bucketOf(hashes[i]);
+            order[start[b] + filled[b]++] = i;
+        }
+
+        // Place the largest buckets first, while the table is mostly empty.
+        size_t largest = 0;
+        for (size_t b = 0; b < BUCKETS; ++b)
+        {
+            largest = (start[b + 1] - start[b] > largest) ? start[b + 1] - start[b] : largest;
+        }
+        for (auto count = largest; count > 0; --count)
+        {
+            for (size_t b = 0; b < BUCKETS; ++b)
+            {
+                if (start[b + 1] - start[b] != count)
+                {
+                    continue;
+                }
+                for (std::uint32_t seed = 1; ; ++seed)
+                {
+                    if (seed > 0xFFFF)
+                    {
+                        throw std::logic_error("StringSet: unable to find a perfect hash");
+                    }
+                    auto placed = start[b];
+                    for (; placed < start[b + 1]; ++placed)
+                    {
+                        if (isDuplicate(keys, order, start[b], placed))
+                        {
+                            continue;
+                        }
+                        auto& slot = m_Slots[slotOf(hashes[order[placed]], seed)];
+                        if (!slot.empty())
+                        {
+                            break;
+                        }
+                        slot = keys[order[placed]];
+                    }
+                    if (placed == start[b + 1])
+                    {
+                        m_Seeds[b] = seed;
+                        break;
+                    }
+                    // Collision, remove the keys placed with this seed and try the next one.
+                    for (auto k = start[b]; k < placed; ++k)
+                    {
+                        if (!isDuplicate(keys, order, start[b], k))
+                        {
+                            m_Slots[slotOf(hashes[order[k]], seed)] = std::string_view("", 0);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Check if the set contains a string, ignoring the case.
+     * @param key String to look for.
+     * @return True if the string is in the set.
+     */
+    constexpr bool contains(std::string_view key) const
+    {
+        if (key.empty())
+        {
+            return false;
+        }
+        auto hash = Detail::hashNoCase(key);
+        auto slot = m_Slots[slotOf(hash, m_Seeds[bucketOf(hash)])];
+        return Detail::equalsNoCase(slot, key);
+    }
+
+protected:
+    constexpr void clear()
+    {
+        // Explicitly assign the empty slots, value initialization is not enough for some compilers
+        // to read them in constant expressions.
+        for (size_t i = 0; i < SLOTS; ++i)
+        {
+            m_Slots[i] = std::string_view("", 0);
+        }
+    }
+
+    static constexpr size_t bucketOf(std::uint32_t hash)
+    {
+        return hash & (BUCKETS - 1);
+    }
+
+    static constexpr size_t slotOf(std::uint32_t hash, std::uint32_t seed)
+    {
+        return Detail::mixHash(hash, seed) & (SLOTS - 1);
+    }
+
+    static constexpr bool isDuplicate(const std::string_view* keys, const std::array<size_t, N>& order,
+                                      size_t first, size_t current)
+    {
+        for (auto k = first; k < current; ++k)
+        {
+            if (Detail::equalsNoCase(keys[order[k]], keys[order[current]]))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+protected:
+    std::array<std::string_view, SLOTS> m_Slots;
+    std::array<std::uint32_t, BUCKETS> m_Seeds;
+};
+
+template <size_t N>
+StringSet(const std::string_view (&keys)[N]) -> StringSet<N>;
+
+}
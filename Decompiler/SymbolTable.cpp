@@ -0,0 +1,113 @@
+#include "SymbolTable.hpp"
+
+#include <cassert>
+
+/**
+ * @brief Constructor
+ * Builds an empty table, not associated with an object.
+ */
+Decompiler::SymbolTable::SymbolTable() :
+    m_Object(nullptr)
+{
+}
+
+/**
+ * @brief Collect the variables of an object.
+ * The previous object and function are discarded.
+ *
+ * @param object Object containing the functions to decompile.
+ */
+void Decompiler::SymbolTable::setObject(const Pex::Object &object)
+{
+    auto table = object.getName().getTable();
+    m_Object = &object;
+    m_ObjectTypes.assign(table->size(), Pex::StringTable::Index());
+    m_FunctionTypes.assign(table->size(), Pex::StringTable::Index());
+    m_FunctionVars.clear();
+    for (auto& var : object.getVariables())
+    {
+        // An undefined name is not in the table
+        auto index = var.getName().asIndex();
+        if (index < m_ObjectTypes.size())
+        {
+            m_ObjectTypes[index] = var.getTypeName();
+        }
+    }
+    m_NoneVar = table->findIdentifier("::nonevar");
+}
+
+/**
+ * @brief Get the object whose variables are collected.
+ * @return The object given to setObject, or null.
+ */
+const Pex::Object *Decompiler::SymbolTable::getObject() const
+{
+    return m_Object;
+}
+
+/**
+ * @brief Collect the parameters and locals of a function of the object.
+ * They hide the object variables with the same name until the next function.
+ *
+ * @param function Function to decompile.
+ */
+void Decompiler::SymbolTable::setFunction(const Pex::Function &function)
+{
+    assert(m_Object != nullptr);
+    for (auto var : m_FunctionVars)
+    {
+        m_FunctionTypes[var] = Pex::StringTable::Index();
+    }
+    m_FunctionVars.clear();
+    for (auto& var : function.getParams())
+    {
+        addFunctionVar(var.getName(), var.getTypeName());
+    }
+    for (auto& var : function.getLocals())
+    {
+        addFunctionVar(var.getName(), var.getTypeName());
+    }
+}
+
+/**
+ * @brief Record the type of a parameter or a local of the function.
+ * A variable whose name is undefined, outside of the string table, is ignored.
+ *
+ * @param name Name of the variable.
+ * @param type Type of the variable.
+ */
+void Decompiler::SymbolTable::addFunctionVar(const Pex::StringTable::Index &name, const Pex::StringTable::Index &type)
+{
+    auto index = name.asIndex();
+    if (index < m_FunctionTypes.size())
+    {
+        m_FunctionVars.push_back(index);
+        m_FunctionTypes[index] = type;
+    }
+}
+
+/**
+ * @brief Get the type of a variable.
+ * @param var Name of the variable.
+ * @return The type of the variable, or an invalid index if the variable is unknown.
+ */
+const Pex::StringTable::Index &Decompiler::SymbolTable::typeOf(const Pex::StringTable::Index &var) const
+{
+    static const Pex::StringTable::Index UNDEFINED;
+    auto index = var.asIndex();
+    if (index >= m_ObjectTypes.size())
+    {
+        return UNDEFINED;
+    }
+    auto& type = m_FunctionTypes[index];
+    return type.getTable() ? type : m_ObjectTypes[index];
+}
+
+/**
+ * @brief Get the name of the variable receiving the discarded results.
+ * @return The index of ::nonevar in the string table of the object.
+ */
+const Pex::StringTable::Index &Decompiler::SymbolTable::getNoneVar() const
+{
+    return m_NoneVar;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Pex/Function.hpp"
+#include "Pex/Object.hpp"
+#include "Pex/StringTable.hpp"
+
+namespace Decompiler {
+
+/**
+ * @brief Types of the variables accessible from the functions of an object.
+ *
+ * The types are stored in dense arrays indexed by the string index of the variable name.
+ * The object variables are collected once per object; the parameters and locals of the
+ * function being decompiled are stored in an overlay, reset when the next function starts.
+ */
+class SymbolTable
+{
+public:
+    SymbolTable();
+
+    void setObject(const Pex::Object& object);
+    const Pex::Object* getObject() const;
+    void setFunction(const Pex::Function& function);
+
+    const Pex::StringTable::Index& typeOf(const Pex::StringTable::Index& var) const;
+    const Pex::StringTable::Index& getNoneVar() const;
+
+protected:
+    void addFunctionVar(const Pex::StringTable::Index& name, const Pex::StringTable::Index& type);
+
+    const Pex::Object* m_Object;
+    std::vector<Pex::StringTable::Index> m_ObjectTypes;
+    std::vector<Pex::StringTable::Index> m_FunctionTypes;
+    std::vector<std::uint16_t> m_FunctionVars;
+    Pex::StringTable::Index m_NoneVar;
+};
+
+}
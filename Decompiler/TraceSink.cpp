@@ -0,0 +1,105 @@
+#include "TraceSink.hpp"
+
+#include <fstream>
+#include <iostream>
+
+/**
+ * @brief Get the process wide trace sink.
+ * The writer thread is started on first use.
+ *
+ * @return The trace sink.
+ */
+Decompiler::TraceSink &Decompiler::TraceSink::instance()
+{
+    static TraceSink sink;
+    return sink;
+}
+
+/**
+ * @brief Constructor
+ * Starts the writer thread.
+ */
+Decompiler::TraceSink::TraceSink() :
+    m_Writing(false),
+    m_Stop(false)
+{
+    m_Thread = std::thread(&TraceSink::run, this);
+}
+
+/**
+ * @brief Destructor
+ * Writes the pending traces and stops the writer thread.
+ */
+Decompiler::TraceSink::~TraceSink()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Pending.notify_one();
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+}
+
+/**
+ * @brief Queue a trace to be written.
+ *
+ * @param path Path of the trace file. An existing file is overwritten.
+ * @param contents Content of the trace file.
+ */
+void Decompiler::TraceSink::write(std::string path, std::string contents)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Queue.push_back(Entry{std::move(path), std::move(contents)});
+    }
+    m_Pending.notify_one();
+}
+
+/**
+ * @brief Wait until all the queued traces are written.
+ */
+void Decompiler::TraceSink::flush()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Drained.wait(lock, [this] { return m_Queue.empty() && !m_Writing; });
+}
+
+/**
+ * @brief Writer thread loop.
+ */
+void Decompiler::TraceSink::run()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true)
+    {
+        m_Pending.wait(lock, [this] { return m_Stop || !m_Queue.empty(); });
+        if (m_Queue.empty())
+        {
+            break;
+        }
+        auto entry = std::move(m_Queue.front());
+        m_Queue.pop_front();
+        m_Writing = true;
+        lock.unlock();
+
+        std::ofstream file(entry.path, std::ios::binary);
+        if (file.fail())
+        {
+            std::cerr << "Failed to open " << entry.path << ", trace discarded." << std::endl;
+        }
+        else
+        {
+            file.write(entry.contents.data(), entry.contents.size());
+        }
+
+        lock.lock();
+        m_Writing = false;
+        if (m_Queue.empty())
+        {
+            m_Drained.notify_all();
+        }
+    }
+}
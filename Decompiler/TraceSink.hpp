@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Decompiler {
+
+/**
+ * @brief Background writer for the decompilation traces.
+ *
+ * The decompiler accumulates the trace of a whole script in memory and hands it
+ * over to the sink once the script is done. A single writer thread, shared by the
+ * whole process, writes the traces to disk so the decompilation never waits on I/O.
+ */
+class TraceSink
+{
+public:
+    static TraceSink& instance();
+    ~TraceSink();
+
+    void write(std::string path, std::string contents);
+    void flush();
+
+protected:
+    TraceSink();
+    void run();
+
+protected:
+    struct Entry
+    {
+        std::string path;
+        std::string contents;
+    };
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Pending;
+    std::condition_variable m_Drained;
+    std::deque<Entry> m_Queue;
+    bool m_Writing;
+    bool m_Stop;
+    std::thread m_Thread;
+};
+
+}
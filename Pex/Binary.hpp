@@ -16,7 +16,6 @@ namespace Pex {
  * The Binary class reflect the content of a PEX file.
  *
  */
-class FileReader;
 class Binary
 {
 public:
@@ -45,12 +44,11 @@ public:
     Objects& getObjects();
 
     ScriptType getGameType() const;
+    void setScriptType(ScriptType game_type);
 
     void sort();
     
 protected:
-    friend FileReader;
-    void setScriptType(ScriptType game_type);
     Header m_Header;
     StringTable m_StringTable;
     DebugInfo m_DebugInfo;
@@ -46,7 +46,7 @@ constexpr Integer byteswap(const Integer _Val) noexcept {
     }
 }
 
-float byteswap_float(const float _Val) noexcept {
+inline float byteswap_float(const float _Val) noexcept {
     float retVal;
     const auto pVal = reinterpret_cast<const char*>(& _Val);
     const auto pRetVal = reinterpret_cast<char*>(& retVal);
@@ -198,24 +198,48 @@ Pex::DebugInfo::FunctionInfo::LineNumbers &Pex::DebugInfo::FunctionInfo::getLine
     return m_LineNumbers;
 }
 
-std::vector<uint16_t> Pex::DebugInfo::FunctionInfo::getLineNumbersForIpRange(int64_t begin, int64_t end) const {
-  if (begin < 0 || end < 0){
-    return {};
-  }
-  // no debug info
-  if (m_LineNumbers.empty() || begin > m_LineNumbers.size() - 1) {
-    return {};
-  }
-  std::vector<uint16_t> result;
-  int64_t line = -1;
-  for (auto i = begin; i <= end; ++i)
-  {
-    if (i < m_LineNumbers.size() && std::find(result.begin(), result.end(), m_LineNumbers[i]) == result.end())
+/**
+ * @brief Constructor
+ * Builds the index of the line numbers of a function.
+ *
+ * @param lineNumbers Line number of each instruction of the function.
+ */
+Pex::DebugInfo::LineIndex::LineIndex(const FunctionInfo::LineNumbers &lineNumbers)
+{
+    m_RunOfIp.reserve(lineNumbers.size());
+    for (auto line : lineNumbers)
+    {
+        if (m_RunLine.empty() || m_RunLine.back() != line)
+        {
+            m_RunLine.push_back(line);
+        }
+        m_RunOfIp.push_back(static_cast<std::uint32_t>(m_RunLine.size() - 1));
+    }
+}
+
+/**
+ * @brief Retrieve the distinct source lines of an instruction range.
+ *
+ * @param begin First instruction of the range.
+ * @param end Last instruction of the range, included.
+ * @param[out] lines Receives the lines, in order of first appearance.
+ */
+void Pex::DebugInfo::LineIndex::getLines(int64_t begin, int64_t end, std::vector<std::uint16_t> &lines) const
+{
+    lines.clear();
+    if (begin < 0 || end < begin || static_cast<uint64_t>(begin) >= m_RunOfIp.size())
+    {
+        return;
+    }
+    auto last = std::min(static_cast<uint64_t>(end), static_cast<uint64_t>(m_RunOfIp.size() - 1));
+    for (auto run = m_RunOfIp[begin]; run <= m_RunOfIp[last]; ++run)
     {
-      result.push_back(m_LineNumbers[i]);
+        auto line = m_RunLine[run];
+        if (std::find(lines.begin(), lines.end(), line) == lines.end())
+        {
+            lines.push_back(line);
+        }
     }
-  }
-  return result;
 }
 
 
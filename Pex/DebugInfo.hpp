@@ -66,7 +66,6 @@ public:
 
         const LineNumbers& getLineNumbers() const;
         LineNumbers& getLineNumbers();
-        std::vector<uint16_t> getLineNumbersForIpRange(int64_t begin, int64_t end) const;
 
      private:
         StringTable::Index m_ObjectName;
@@ -77,6 +76,27 @@ public:
         LineNumbers m_LineNumbers;
     };
 
+    /**
+     * @brief Index of the source lines of a function, by instruction range.
+     *
+     * The line numbers are compressed in runs of consecutive instructions on the same
+     * line, so a range query only visits the runs it covers instead of every instruction.
+     */
+    class LineIndex
+    {
+    public:
+        LineIndex() = default;
+        explicit LineIndex(const FunctionInfo::LineNumbers& lineNumbers);
+
+        void getLines(int64_t begin, int64_t end, std::vector<std::uint16_t>& lines) const;
+
+    private:
+        // Run of each instruction
+        std::vector<std::uint32_t> m_RunOfIp;
+        // Line of each run
+        std::vector<std::uint16_t> m_RunLine;
+    };
+
     class PropertyGroup :
             public DocumentedItem,
             public UserFlagged
@@ -41,6 +41,20 @@ Pex::FileReader::FileReader(std::istream *stream):
     }
 }
 
+/**
+ * @brief Construct from the bytes of a file
+ * The bytes are parsed in place, they must outlive the reader.
+ * @param[in] data First byte of the file.
+ * @param[in] size Size of the file.
+ */
+Pex::FileReader::FileReader(const char *data, size_t size):
+    m_StringTable(nullptr),
+    m_memoryBuffer(data, size)
+{
+    m_memoryStream.rdbuf(&m_memoryBuffer);
+    m_iStream = &m_memoryStream;
+}
+
 /**
  * @brief Default destructor
  */
@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <ctime>
 #include <fstream>
+#include <istream>
+#include <streambuf>
 
 #include "Binary.hpp"
 
@@ -12,13 +14,14 @@ namespace Pex {
  * @brief Binary structure file reading.
  *
  * The FileReader class provides a function to read a PEX file into a Binary structure.
- * The filename is provided as a parameter of the constructor.
+ * The filename, a stream or the bytes of the file are provided as a parameter of the constructor.
  */
 class FileReader
 {
 public:
     FileReader(std::istream *stream);
     FileReader(const std::string& fileName);
+    FileReader(const char* data, size_t size);
     ~FileReader();
 
     void read(Binary& binary);
@@ -61,8 +64,24 @@ protected:
     const StringTable* m_StringTable;
 
 private:
+    /**
+     * @brief Read-only stream buffer over bytes already in memory, read without copy.
+     */
+    class MemoryBuffer : public std::streambuf
+    {
+    public:
+        MemoryBuffer() = default;
+        MemoryBuffer(const char* data, size_t size)
+        {
+            auto begin = const_cast<char*>(data);
+            setg(begin, begin, begin + size);
+        }
+    };
+
     Endianness m_endianness;
     std::istream* m_iStream;
     std::ifstream m_fileStream;
+    MemoryBuffer m_memoryBuffer;
+    std::istream m_memoryStream{nullptr};
 };
 }
@@ -0,0 +1,534 @@
+#include "FileWriter.hpp"
+#include "FileReader.hpp"
+#include "ByteSwap.hpp"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+/**
+ * @brief Construct from file name
+ * @param[in] fileName name of the pex file.
+ *
+ * @throws runtime_error if the file can't be opened
+ */
+Pex::FileWriter::FileWriter(const std::string &fileName) :
+    m_BigEndian(false),
+    m_Starfield(false),
+    m_fileStream(fileName, std::ofstream::binary)
+{
+    m_oStream = &m_fileStream;
+    if (m_oStream->fail())
+    {
+        throw std::runtime_error("Unable to open file");
+    }
+}
+
+/**
+ * @brief Construct from ostream
+ * @param[in] stream pointer to ostream.
+ *
+ * @throws runtime_error if the ostream is bad
+ */
+Pex::FileWriter::FileWriter(std::ostream *stream) :
+    m_BigEndian(false),
+    m_Starfield(false),
+    m_oStream(stream),
+    m_fileStream()
+{
+    if (m_oStream->fail())
+    {
+        throw std::runtime_error("ostream is bad");
+    }
+}
+
+/**
+ * @brief Default destructor
+ */
+Pex::FileWriter::~FileWriter()
+{
+}
+
+/**
+ * @brief Writes the binary structure to the associated output.
+ * @param[in] binary Structure to write.
+ *
+ * @throws runtime_error if the structure can't be represented in a PEX file, or if the output fails.
+ */
+void Pex::FileWriter::write(const Pex::Binary &binary)
+{
+    m_BigEndian = binary.getGameType() == Pex::Binary::SkyrimScript;
+    m_Starfield = binary.getGameType() == Pex::Binary::StarfieldScript;
+    m_Buffer.clear();
+
+    writeHeader(binary.getHeader());
+    write(binary.getStringTable());
+    write(binary.getDebugInfo());
+    write(binary.getUserFlags());
+    write(binary.getObjects());
+
+    m_oStream->write(m_Buffer.data(), m_Buffer.size());
+    m_oStream->flush();
+    if (m_oStream->fail())
+    {
+        throw std::runtime_error("Error writing file");
+    }
+}
+
+/**
+ * @brief Writes the Header
+ * @param[in] header Header to write
+ */
+void Pex::FileWriter::writeHeader(const Pex::Header &header)
+{
+    // the magic number is read as little endian to detect the endianness
+    auto magic = m_BigEndian ? FileReader::BE_MAGIC_NUMBER : FileReader::LE_MAGIC_NUMBER;
+    m_Buffer.append(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    putUint8(header.getMajorVersion());
+    putUint8(header.getMinorVersion());
+    putUint16(header.getGameID());
+    putTime(header.getCompilationTime());
+    putString(header.getSourceFileName());
+    putString(header.getUserName());
+    putString(header.getComputerName());
+}
+
+/**
+ * @brief Writes the string table.
+ * @param[in] stringTable table to write
+ */
+void Pex::FileWriter::write(const Pex::StringTable &stringTable)
+{
+    putCount(stringTable.size());
+    for (auto& string : stringTable)
+    {
+        putString(string);
+    }
+}
+
+/**
+ * @brief Writes the debug info package
+ * @param[in] debugInfo DebugInfo object to write.
+ */
+void Pex::FileWriter::write(const Pex::DebugInfo &debugInfo)
+{
+    // The reader leaves the modification time to zero when there is no debug info
+    bool hasDebugInfo = debugInfo.getModificationTime() != 0 || !debugInfo.getFunctionInfos().empty();
+    putUint8(hasDebugInfo ? 1 : 0);
+    if (!hasDebugInfo)
+    {
+        return;
+    }
+    putTime(debugInfo.getModificationTime());
+
+    putCount(debugInfo.getFunctionInfos().size());
+    for (auto& functionInfo : debugInfo.getFunctionInfos())
+    {
+        putStringIndex(functionInfo.getObjectName());
+        putStringIndex(functionInfo.getStateName());
+        putStringIndex(functionInfo.getFunctionName());
+        putUint8(static_cast<std::uint8_t>(functionInfo.getFunctionType()));
+        putCount(functionInfo.getLineNumbers().size());
+        for (auto line : functionInfo.getLineNumbers())
+        {
+            putUint16(line);
+        }
+    }
+    // Skyrim scripts do not have the following info
+    if (m_BigEndian)
+    {
+        return;
+    }
+    putCount(debugInfo.getPropertyGroups().size());
+    for (auto& propertyGroup : debugInfo.getPropertyGroups())
+    {
+        putStringIndex(propertyGroup.getObjectName());
+        putStringIndex(propertyGroup.getGroupName());
+        putStringIndex(propertyGroup.getDocString());
+        putUint32(propertyGroup.getUserFlags());
+        putCount(propertyGroup.getNames().size());
+        for (auto& name : propertyGroup.getNames())
+        {
+            putStringIndex(name);
+        }
+    }
+
+    putCount(debugInfo.getStructOrders().size());
+    for (auto& structOrder : debugInfo.getStructOrders())
+    {
+        putStringIndex(structOrder.getObjectName());
+        putStringIndex(structOrder.getOrderName());
+        putCount(structOrder.getNames().size());
+        for (auto& name : structOrder.getNames())
+        {
+            putStringIndex(name);
+        }
+    }
+}
+
+/**
+ * @brief Writes the User Flags definition.
+ * @param[in] userFlags UserFlag collection to write.
+ */
+void Pex::FileWriter::write(const Pex::UserFlags &userFlags)
+{
+    putCount(userFlags.size());
+    for (auto& userFlag : userFlags)
+    {
+        putStringIndex(userFlag.getName());
+        putUint8(userFlag.getFlagIndex());
+    }
+}
+
+/**
+ * @brief Writes the Objects definitions.
+ * The size of each object is patched once the object is written.
+ *
+ * @param[in] objects Object collection to write.
+ */
+void Pex::FileWriter::write(const Pex::Objects &objects)
+{
+    putCount(objects.size());
+    for (auto& object : objects)
+    {
+        putStringIndex(object.getName());
+        auto sizeOffset = m_Buffer.size();
+        putUint32(0);
+
+        putStringIndex(object.getParentClassName());
+        putStringIndex(object.getDocString());
+        // Skyrim scripts do not have this info
+        if (!m_BigEndian)
+        {
+            putUint8(object.getConstFlag());
+        }
+        putUint32(object.getUserFlags());
+        putStringIndex(object.getAutoStateName());
+        // Skyrim scripts do not have this info
+        if (!m_BigEndian)
+        {
+            write(object.getStructInfos());
+        }
+        write(object.getVariables());
+        if (m_Starfield)
+        {
+            write(object.getGuards());
+        }
+        write(object.getProperties());
+        write(object.getStates());
+
+        // The size includes the size field itself
+        auto size = static_cast<std::uint32_t>(m_Buffer.size() - sizeOffset);
+        if (m_BigEndian)
+        {
+            size = byteswap(size);
+        }
+        std::memcpy(&m_Buffer[sizeOffset], &size, sizeof(size));
+    }
+}
+
+/**
+ * @brief Writes the StructInfos definition for an object
+ * @param[in] structInfos struct info collection to write.
+ */
+void Pex::FileWriter::write(const Pex::StructInfos &structInfos)
+{
+    putCount(structInfos.size());
+    for (auto& info : structInfos)
+    {
+        putStringIndex(info.getName());
+        putCount(info.getMembers().size());
+        for (auto& member : info.getMembers())
+        {
+            putStringIndex(member.getName());
+            putStringIndex(member.getTypeName());
+            putUint32(member.getUserFlags());
+            putValue(member.getValue());
+            putUint8(member.getConstFlag());
+            putStringIndex(member.getDocString());
+        }
+    }
+}
+
+/**
+ * @brief Writes the Variables definition for an object
+ * @param[in] variables collection to write.
+ */
+void Pex::FileWriter::write(const Pex::Variables &variables)
+{
+    putCount(variables.size());
+    for (auto& variable : variables)
+    {
+        putStringIndex(variable.getName());
+        putStringIndex(variable.getTypeName());
+        putUint32(variable.getUserFlags());
+        putValue(variable.getDefaultValue());
+        // Skyrim scripts do not have this info
+        if (!m_BigEndian)
+        {
+            putUint8(variable.getConstFlag());
+        }
+    }
+}
+
+/**
+ * @brief Writes the Properties definition for an object
+ * @param[in] properties collection to write.
+ */
+void Pex::FileWriter::write(const Pex::Properties &properties)
+{
+    putCount(properties.size());
+    for (auto& property : properties)
+    {
+        putStringIndex(property.getName());
+        putStringIndex(property.getTypeName());
+        putStringIndex(property.getDocString());
+        putUint32(property.getUserFlags());
+        putUint8(static_cast<std::uint8_t>(property.getFlags()));
+        if (property.hasAutoVar())
+        {
+            putStringIndex(property.getAutoVarName());
+        }
+        else
+        {
+            if (property.isReadable())
+            {
+                write(property.getReadFunction());
+            }
+            if (property.isWritable())
+            {
+                write(property.getWriteFunction());
+            }
+        }
+    }
+}
+
+/**
+ * @brief Writes the States definition for an object
+ * @param[in] states collection to write.
+ */
+void Pex::FileWriter::write(const Pex::States &states)
+{
+    putCount(states.size());
+    for (auto& state : states)
+    {
+        putStringIndex(state.getName());
+        write(state.getFunctions());
+    }
+}
+
+/**
+ * @brief Writes the Guards definition for an object
+ * @param[in] guards collection to write.
+ */
+void Pex::FileWriter::write(const Pex::Guards &guards)
+{
+    putCount(guards.size());
+    for (auto& guard : guards)
+    {
+        putStringIndex(guard.getName());
+    }
+}
+
+/**
+ * @brief Writes the Functions definition for a state
+ * @param[in] functions collection to write.
+ */
+void Pex::FileWriter::write(const Pex::Functions &functions)
+{
+    putCount(functions.size());
+    for (auto& function : functions)
+    {
+        putStringIndex(function.getName());
+        write(function);
+    }
+}
+
+/**
+ * @brief Writes a function body
+ * @param[in] function Function structure to write.
+ */
+void Pex::FileWriter::write(const Pex::Function &function)
+{
+    putStringIndex(function.getReturnTypeName());
+    putStringIndex(function.getDocString());
+    putUint32(function.getUserFlags());
+    putUint8(function.getFlags());
+    write(function.getParams());
+    write(function.getLocals());
+    write(function.getInstructions());
+}
+
+/**
+ * @brief Writes the parameter or local variable definitions of a function
+ * @param[in] typednames collection to write.
+ */
+void Pex::FileWriter::write(const Pex::TypedNames &typednames)
+{
+    putCount(typednames.size());
+    for (auto& typedname : typednames)
+    {
+        putStringIndex(typedname.getName());
+        putStringIndex(typedname.getTypeName());
+    }
+}
+
+/**
+ * @brief Writes the instruction list of a function body
+ * @param[in] instructions collection to write.
+ */
+void Pex::FileWriter::write(const Pex::Instructions &instructions)
+{
+    putCount(instructions.size());
+    for (auto& instruction : instructions)
+    {
+        putUint8(static_cast<std::uint8_t>(instruction.getOpCode()));
+        for (auto& arg : instruction.getArgs())
+        {
+            putValue(arg);
+        }
+        if (instruction.hasVarArgs())
+        {
+            putValue(Value(static_cast<std::int32_t>(instruction.getVarArgs().size())));
+            for (auto& arg : instruction.getVarArgs())
+            {
+                putValue(arg);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Writes a byte.
+ * @param value Byte to write.
+ */
+void Pex::FileWriter::putUint8(std::uint8_t value)
+{
+    m_Buffer.push_back(static_cast<char>(value));
+}
+
+/**
+ * @brief Writes a 16 bit unsigned int.
+ * If file is big endian, byteswaps the value.
+ * @param value Value to write.
+ */
+void Pex::FileWriter::putUint16(std::uint16_t value)
+{
+    if (m_BigEndian)
+    {
+        value = byteswap(value);
+    }
+    m_Buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * @brief Writes a 32 bit unsigned int.
+ * If file is big endian, byteswaps the value.
+ * @param value Value to write.
+ */
+void Pex::FileWriter::putUint32(std::uint32_t value)
+{
+    if (m_BigEndian)
+    {
+        value = byteswap(value);
+    }
+    m_Buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * @brief Writes the 16 bit size of a collection.
+ * @param count Size of the collection.
+ *
+ * @throws runtime_error if the collection is too large for the PEX format.
+ */
+void Pex::FileWriter::putCount(size_t count)
+{
+    if (count > std::numeric_limits<std::uint16_t>::max())
+    {
+        throw std::runtime_error("Too many elements for a PEX file");
+    }
+    putUint16(static_cast<std::uint16_t>(count));
+}
+
+/**
+ * @brief Writes a string index.
+ * @param index Index to write.
+ */
+void Pex::FileWriter::putStringIndex(const Pex::StringTable::Index &index)
+{
+    if (!index.isValid())
+    {
+        throw std::runtime_error("Invalid string index");
+    }
+    putUint16(index.asIndex());
+}
+
+/**
+ * @brief Writes a 32 bit float.
+ * If file is big endian, byteswaps the value.
+ * @param value Value to write.
+ */
+void Pex::FileWriter::putFloat(float value)
+{
+    if (m_BigEndian)
+    {
+        value = byteswap_float(value);
+    }
+    m_Buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * @brief Writes a 64 bit time_t.
+ * If file is big endian, byteswaps the value.
+ * @param value Value to write.
+ */
+void Pex::FileWriter::putTime(std::time_t value)
+{
+    static_assert(sizeof(std::time_t) == 8, "time_t is not 64 bits");
+    if (m_BigEndian)
+    {
+        value = byteswap(value);
+    }
+    m_Buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * @brief Writes a variable sized string.
+ * @param value String to write.
+ */
+void Pex::FileWriter::putString(const std::string &value)
+{
+    putCount(value.size());
+    m_Buffer.append(value);
+}
+
+/**
+ * @brief Writes a variant typed value.
+ * @param value Value to write.
+ */
+void Pex::FileWriter::putValue(const Pex::Value &value)
+{
+    putUint8(static_cast<std::uint8_t>(value.getType()));
+    switch (value.getType())
+    {
+    case Pex::ValueType::None:
+        break;
+    case Pex::ValueType::Identifier:
+        putStringIndex(value.getId());
+        break;
+    case Pex::ValueType::String:
+        putStringIndex(value.getString());
+        break;
+    case Pex::ValueType::Integer:
+        putUint32(static_cast<std::uint32_t>(value.getInteger()));
+        break;
+    case Pex::ValueType::Float:
+        putFloat(value.getFloat());
+        break;
+    case Pex::ValueType::Bool:
+        putUint8(value.getBool() ? 1 : 0);
+        break;
+    default:
+        throw std::runtime_error("Invalid value type");
+    }
+}
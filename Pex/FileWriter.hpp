@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <string>
+
+#include "Binary.hpp"
+
+namespace Pex {
+
+/**
+ * @brief Binary structure file writing.
+ *
+ * The FileWriter class is the counterpart of the FileReader: it writes a Binary structure
+ * in the PEX format of its game type, big endian for Skyrim and little endian otherwise.
+ * The file is assembled in memory and written to the output in one block.
+ */
+class FileWriter
+{
+public:
+    FileWriter(std::ostream *stream);
+    FileWriter(const std::string& fileName);
+    ~FileWriter();
+
+    void write(const Binary& binary);
+
+protected:
+    void writeHeader(const Header& header);
+    void write(const StringTable& stringTable);
+    void write(const DebugInfo& debugInfo);
+    void write(const UserFlags& userFlags);
+    void write(const Objects& objects);
+    void write(const StructInfos& structInfos);
+    void write(const Variables& variables);
+    void write(const Properties& properties);
+    void write(const States& states);
+    void write(const Guards& guards);
+    void write(const Functions& functions);
+    void write(const Function& function);
+    void write(const TypedNames& typednames);
+    void write(const Instructions& instructions);
+
+    void putUint8(std::uint8_t value);
+    void putUint16(std::uint16_t value);
+    void putUint32(std::uint32_t value);
+    void putCount(size_t count);
+    void putStringIndex(const StringTable::Index& index);
+    void putFloat(float value);
+    void putTime(std::time_t value);
+    void putString(const std::string& value);
+    void putValue(const Value& value);
+
+private:
+    bool m_BigEndian;
+    bool m_Starfield;
+    std::string m_Buffer;
+    std::ostream* m_oStream;
+    std::ofstream m_fileStream;
+};
+}
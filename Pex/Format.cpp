@@ -0,0 +1,94 @@
+#include "Format.hpp"
+
+#include <cmath>
+
+/**
+ * @brief Append an integer in upper case hexadecimal.
+ * @param out String receiving the text.
+ * @param value Value to append, with the minimal width.
+ */
+void Pex::Format::appendHex(std::string &out, const Hex &value)
+{
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value.value, 16);
+    auto length = static_cast<size_t>(result.ptr - buffer);
+    if (length < value.width)
+    {
+        out.append(value.width - length, '0');
+    }
+    for (auto c = buffer; c != result.ptr; ++c)
+    {
+        out.push_back((*c >= 'a' && *c <= 'f') ? static_cast<char>(*c - 'a' + 'A') : *c);
+    }
+}
+
+/**
+ * @brief Append a float with the shortest decimal notation reading back the same value.
+ * The scientific notation is never used, and a integral value always has a decimal part,
+ * so the text is a valid Papyrus float literal.
+ *
+ * @param out String receiving the text.
+ * @param value Value to append.
+ */
+void Pex::Format::appendFloat(std::string &out, float value)
+{
+    // Large enough for the longest float in fixed notation, the smallest denormal.
+    char buffer[64];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed);
+    out.append(buffer, result.ptr);
+    if (std::isfinite(value) && std::string_view(buffer, result.ptr - buffer).find('.') == std::string_view::npos)
+    {
+        out.append(".0");
+    }
+}
+
+/**
+ * @brief Append a string, escaping the characters not allowed in a string literal.
+ * @param out String receiving the text.
+ * @param text String to escape. The quotes are not added.
+ */
+void Pex::Format::appendEscaped(std::string &out, std::string_view text)
+{
+    auto start = text.begin();
+    for (auto it = text.begin(); it != text.end(); ++it)
+    {
+        const char* escape;
+        switch (*it)
+        {
+        case '\n':
+            escape = "\\n";
+            break;
+        case '\t':
+            escape = "\\t";
+            break;
+        case '\\':
+            escape = "\\\\";
+            break;
+        case '\"':
+            escape = "\\\"";
+            break;
+        default:
+            continue;
+        }
+        out.append(start, it);
+        out.append(escape);
+        start = it + 1;
+    }
+    out.append(start, text.end());
+}
+
+/**
+ * @brief Append a time, converted to local time.
+ * @param out String receiving the text.
+ * @param time Time to append.
+ */
+void Pex::Format::appendTime(std::string &out, const LocalTime &time)
+{
+    auto local = std::localtime(&time.time);
+    if (local)
+    {
+        char buffer[32];
+        auto length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", local);
+        out.append(buffer, length);
+    }
+}
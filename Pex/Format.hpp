@@ -0,0 +1,117 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace Pex {
+
+/**
+ * @brief Text formatting helpers.
+ *
+ * The values are formatted with std::to_chars and appended to an existing string,
+ * so the callers can build their text in place in reusable buffers, without
+ * streams nor temporary strings.
+ */
+namespace Format {
+
+/**
+ * @brief Integer padded to a minimum width.
+ */
+template <typename T>
+struct Padded
+{
+    T value;
+    size_t width;
+    char fill;
+};
+
+/**
+ * @brief Integer written in upper case hexadecimal, padded with zeros.
+ */
+struct Hex
+{
+    std::uint64_t value;
+    size_t width;
+};
+
+/**
+ * @brief Time written in local time, as YYYY-MM-DD HH:MM:SS.
+ */
+struct LocalTime
+{
+    std::time_t time;
+};
+
+/**
+ * @brief Append an integer.
+ * @param out String receiving the text.
+ * @param value Value to append.
+ */
+template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+void appendInteger(std::string& out, T value)
+{
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+/**
+ * @brief Append an integer, right aligned on a minimum width.
+ * @param out String receiving the text.
+ * @param value Value to append.
+ */
+template <typename T>
+void appendPadded(std::string& out, const Padded<T>& value)
+{
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value.value);
+    auto length = static_cast<size_t>(result.ptr - buffer);
+    if (length < value.width)
+    {
+        out.append(value.width - length, value.fill);
+    }
+    out.append(buffer, result.ptr);
+}
+
+void appendHex(std::string& out, const Hex& value);
+void appendFloat(std::string& out, float value);
+void appendEscaped(std::string& out, std::string_view text);
+void appendTime(std::string& out, const LocalTime& time);
+
+/**
+ * @brief Build a padded integer, in the manner of std::setw and std::setfill.
+ * @param value Value to write.
+ * @param width Minimum width.
+ * @param fill Character used to fill up to the width.
+ */
+template <typename T>
+Padded<T> pad(T value, size_t width, char fill = '0')
+{
+    return Padded<T>{value, width, fill};
+}
+
+/**
+ * @brief Build an hexadecimal integer.
+ * @param value Value to write.
+ * @param width Minimum width, filled with zeros.
+ */
+inline Hex hex(std::uint64_t value, size_t width)
+{
+    return Hex{value, width};
+}
+
+/**
+ * @brief Build a local time.
+ * @param time Time to write.
+ */
+inline LocalTime localTime(std::time_t time)
+{
+    return LocalTime{time};
+}
+
+}
+}
@@ -35,6 +35,15 @@ void Pex::Function::setReturnTypeName(Pex::StringTable::Index value)
     m_ReturnTypeName = value;
 }
 
+/**
+ * @brief Retrieve the function flags byte.
+ * @return the flag byte.
+ */
+std::uint8_t Pex::Function::getFlags() const
+{
+    return m_Flags;
+}
+
 /**
  * @brief Sets the function flags byte.
  * @param[in] value Flag byte.
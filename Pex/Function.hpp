@@ -30,6 +30,7 @@ public:
     StringTable::Index getReturnTypeName() const;
     void setReturnTypeName(StringTable::Index value);
 
+    std::uint8_t getFlags() const;
     void setFlags(std::uint8_t value);
     bool isGlobal() const;
     bool isNative() const;
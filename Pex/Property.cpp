@@ -37,6 +37,15 @@ void Pex::Property::setAutoVarName(Pex::StringTable::Index value)
     m_AutoVarName = value;
 }
 
+/**
+ * @brief Retrieve the flags associated with the property
+ * @return the flag value.
+ */
+Pex::PropertyFlag Pex::Property::getFlags() const
+{
+    return m_Flags;
+}
+
 /**
  * @brief Sets the flags associated with the property
  * @param value The new flag value.
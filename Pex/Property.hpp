@@ -51,6 +51,7 @@ public:
     StringTable::Index getAutoVarName() const;
     void setAutoVarName(StringTable::Index value);
 
+    PropertyFlag getFlags() const;
     void setFlags(PropertyFlag value);
     bool isReadable() const;
     bool isWritable() const;
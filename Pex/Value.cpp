@@ -2,8 +2,8 @@
 
 #include <stdexcept>
 #include <cassert>
-#include <sstream>
-#include <iomanip>
+
+#include "Format.hpp"
 
 
 /**
@@ -237,81 +237,56 @@ bool Pex::Value::operator ==(const Pex::Value &rhs) const
  */
 std::string Pex::Value::toString() const
 {
-    std::ostringstream result;
+    std::string result;
+    appendTo(result);
+    return result;
+}
+
+/**
+ * @brief Append the value to a string.
+ * @param out String receiving the value as a Papyrus literal.
+ */
+void Pex::Value::appendTo(std::string &out) const
+{
     auto type = getType();
     switch(type)
     {
         case Pex::ValueType::None:
         {
-            result << "None";
+            out.append("None");
             break;
         }
         case Pex::ValueType::Identifier:
         {
-            result << getId().asString();
+            out.append(getId().asString());
             break;
         }
         case Pex::ValueType::String:
         {
-            result << '"';
-            for (auto c : getString().asString())
-            {
-                switch(c)
-                {
-                case '\n':
-                    result << "\\n";
-                    break;
-                case '\t':
-                    result << "\\t";
-                    break;
-                case '\\':
-                    result << "\\\\";
-                    break;
-                case '\"':
-                    result << "\\\"";
-                    break;
-                default:
-                    result << c;
-                    break;
-                }
-            }
-            result << '"';
+            out.push_back('"');
+            Format::appendEscaped(out, getString().asString());
+            out.push_back('"');
             break;
         }
         case Pex::ValueType::Integer:
         {
-            result << getInteger();
+            Format::appendInteger(out, getInteger());
             break;
         }
         case Pex::ValueType::Float:
         {
-            result << std::showpoint << std::fixed << std::setprecision(9) << getFloat();
-
-            // Prevent a point to be the last character.
-            if (result.str().back() == '.') {
-                result << "0";
-            }
-
-            auto str = result.str();
-            size_t i = str.length() - 1;
-            for (; i >= 0; i--) {
-                if (str[i] != '0') {
-                    if (str[i] == '.')
-                        i++;
-                    break;
-                }
-            }
-            return str.substr(0, i + 1);
+            Format::appendFloat(out, getFloat());
+            break;
         }
         case Pex::ValueType::Bool:
-            result << (getBool() ? "True" : "False");
+            out.append(getBool() ? "True" : "False");
             break;
         default:
-            result << "*error invalid value type #" << (uint8_t) type << "*";
+            out.append("*error invalid value type #");
+            Format::appendInteger(out, static_cast<int>(type));
+            out.push_back('*');
             break;
     }
-
-    return result.str();
 }
 
 /**
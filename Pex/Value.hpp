@@ -55,6 +55,7 @@ public:
     bool               operator==(const Value& rhs) const;
 
     std::string        toString() const;
+    void               appendTo(std::string& out) const;
 
 protected:
     ValueType m_Type;
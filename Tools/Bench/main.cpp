@@ -0,0 +1,418 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <iostream>
+#include <sstream>
+
+#include <boost/program_options.hpp>
+namespace options = boost::program_options;
+
+#include "Champollion/AllocationCounter.hpp"
+
+#include "Pex/Binary.hpp"
+#include "Pex/FileReader.hpp"
+
+#include "Decompiler/AsmCoder.hpp"
+#include "Decompiler/OutputWriter.hpp"
+#include "Decompiler/PassProfile.hpp"
+#include "Decompiler/PscCoder.hpp"
+#include "Decompiler/PscDecompiler.hpp"
+#include "Decompiler/SymbolTable.hpp"
+#include "Decompiler/Version.hpp"
+
+#include "Tools/Common/Generator.hpp"
+#include "Tools/Common/JsonWriter.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief Output writer discarding the lines, so the benchmarks do not measure the disk.
+ */
+class NullWriter : public Decompiler::OutputWriter
+{
+public:
+    virtual void writeLine(const std::string& line)
+    {
+        m_Bytes += line.size() + 1;
+    }
+
+    size_t m_Bytes = 0;
+};
+
+struct Params
+{
+    std::string filter;
+    std::string output;
+    std::chrono::milliseconds minTime{200};
+};
+
+struct Result
+{
+    std::string name;
+    size_t iterations = 0;
+    double minNs = 0;
+    double medianNs = 0;
+    double meanNs = 0;
+    size_t bytes = 0;
+    size_t items = 0;
+    // Mean number of allocations per iteration, 0 if not counted
+    double allocations = 0;
+};
+
+struct Input
+{
+    std::string name;
+    std::string bytes;
+    Pex::Binary binary;
+};
+
+class Bench
+{
+public:
+    Bench(const Params& params) : m_Params(params) { }
+
+    /**
+     * @brief Run a benchmark until the minimum time is reached.
+     * @param name Name of the benchmark.
+     * @param bytes Bytes processed by one iteration, 0 if not relevant.
+     * @param items Items processed by one iteration.
+     * @param body Function running one iteration.
+     */
+    void run(const std::string& name, size_t bytes, size_t items, const std::function<void()>& body)
+    {
+        if (!m_Params.filter.empty() && name.find(m_Params.filter) == std::string::npos)
+        {
+            return;
+        }
+        body(); // warm up
+
+        std::vector<double> samples;
+        auto start = Clock::now();
+        while (samples.size() < 3 || Clock::now() - start < m_Params.minTime)
+        {
+            auto begin = Clock::now();
+            body();
+            samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - begin).count());
+        }
+        add(name, samples, bytes, items);
+    }
+
+    /**
+     * @brief Record the samples of a benchmark.
+     * @param name Name of the benchmark.
+     * @param samples Time of each iteration, in nanoseconds.
+     * @param bytes Bytes processed by one iteration.
+     * @param items Items processed by one iteration.
+     */
+    void add(const std::string& name, std::vector<double> samples, size_t bytes, size_t items,
+             double allocations = 0)
+    {
+        Result result;
+        result.name = name;
+        result.iterations = samples.size();
+        std::sort(samples.begin(), samples.end());
+        result.minNs = samples.front();
+        result.medianNs = samples[samples.size() / 2];
+        for (auto sample : samples)
+        {
+            result.meanNs += sample;
+        }
+        result.meanNs /= samples.size();
+        result.bytes = bytes;
+        result.items = items;
+        result.allocations = allocations;
+        std::cerr << name << ": " << result.medianNs / 1e6 << " ms" << std::endl;
+        m_Results.push_back(result);
+    }
+
+    bool selected(const std::string& prefix) const
+    {
+        return m_Params.filter.empty() || prefix.find(m_Params.filter) != std::string::npos
+            || m_Params.filter.find(prefix) != std::string::npos;
+    }
+
+    const std::chrono::milliseconds& getMinTime() const
+    {
+        return m_Params.minTime;
+    }
+
+    void write(std::ostream& stream) const
+    {
+        Tools::JsonWriter json(stream);
+        json.beginObject();
+        json.member("version", CHAMPOLLION_VERSION_STRING);
+        json.key("benchmarks").beginArray();
+        for (auto& result : m_Results)
+        {
+            json.beginObject();
+            json.member("name", result.name);
+            json.member("iterations", std::uint64_t(result.iterations));
+            json.member("min_ns", result.minNs);
+            json.member("median_ns", result.medianNs);
+            json.member("mean_ns", result.meanNs);
+            if (result.bytes)
+            {
+                json.member("bytes", std::uint64_t(result.bytes));
+                json.member("mb_per_s", result.bytes / result.medianNs * 1e3);
+            }
+            if (result.items)
+            {
+                json.member("items", std::uint64_t(result.items));
+                json.member("ns_per_item", result.medianNs / result.items);
+            }
+            if (result.allocations)
+            {
+                json.member("allocations", result.allocations);
+            }
+            json.endObject();
+        }
+        json.endArray();
+        json.endObject();
+    }
+
+protected:
+    Params m_Params;
+    std::vector<Result> m_Results;
+};
+
+/**
+ * @brief Build a synthetic input.
+ * @param input Input to fill in.
+ * @param name Name of the input.
+ * @param params Shape of the script.
+ */
+void makeInput(Input& input, const std::string& name, const Tools::Generator::Params& params)
+{
+    input.name = name;
+    Tools::Generator generator(params);
+    generator.generate(input.binary);
+    input.bytes = Tools::Generator::toBytes(input.binary);
+}
+
+void benchRead(Bench& bench, const Input& input)
+{
+    bench.run("read/" + input.name, input.bytes.size(), 1, [&]() {
+        std::istringstream stream(input.bytes, std::ios::binary);
+        Pex::FileReader reader(&stream);
+        Pex::Binary binary;
+        reader.read(binary);
+    });
+}
+
+void benchStringTable(Bench& bench, const Input& input)
+{
+    auto& table = input.binary.getStringTable();
+    std::vector<std::string> names(table.begin(), table.end());
+    names.push_back("NotInTheTable");
+    bench.run("string_table/findIdentifier/" + input.name, 0, names.size(), [&]() {
+        size_t found = 0;
+        for (auto& name : names)
+        {
+            found += table.findIdentifier(name).isValid();
+        }
+        if (found == 0)
+        {
+            std::abort();
+        }
+    });
+}
+
+void benchValue(Bench& bench, const Input& input)
+{
+    std::vector<const Pex::Value*> values;
+    for (auto& state : input.binary.getObjects()[0].getStates())
+    {
+        for (auto& function : state.getFunctions())
+        {
+            for (auto& instruction : function.getInstructions())
+            {
+                for (auto& arg : instruction.getArgs())
+                {
+                    values.push_back(&arg);
+                }
+            }
+        }
+    }
+    bench.run("value/toString/" + input.name, 0, values.size(), [&]() {
+        size_t length = 0;
+        for (auto value : values)
+        {
+            length += value->toString().size();
+        }
+        if (length == 0)
+        {
+            std::abort();
+        }
+    });
+}
+
+/**
+ * @brief Time each decompilation stage over the functions of an input.
+ * The stages are timed by the pass profile of the decompiler, one sample per pass and iteration.
+ */
+void benchPasses(Bench& bench, const Input& input)
+{
+    if (!bench.selected("decompile/"))
+    {
+        return;
+    }
+    auto& object = input.binary.getObjects()[0];
+    Decompiler::SymbolTable symbols;
+    symbols.setObject(object);
+    auto run = [&](Decompiler::PassProfile* profile) {
+        for (auto& state : object.getStates())
+        {
+            for (auto& function : state.getFunctions())
+            {
+                auto info = input.binary.getDebugInfo().getFunctionInfo(object.getName(), state.getName(),
+                                                                        function.getName());
+                symbols.setFunction(function);
+                Decompiler::PscDecompiler decompiler(function, object, info, false, false, false, nullptr,
+                                                     nullptr, &symbols, profile, 0, nullptr);
+            }
+        }
+    };
+    run(nullptr); // warm up
+
+    std::map<std::string, std::vector<double>> samples;
+    std::map<std::string, std::uint64_t> allocations;
+    std::vector<std::string> order;
+    auto start = Clock::now();
+    size_t iterations = 0;
+    while (iterations < 3 || Clock::now() - start < bench.getMinTime())
+    {
+        Decompiler::PassProfile profile;
+        run(&profile);
+        for (auto& entry : profile.getEntries())
+        {
+            if (samples.find(entry.name) == samples.end())
+            {
+                order.push_back(entry.name);
+            }
+            samples[entry.name].push_back(std::chrono::duration<double, std::nano>(entry.time).count());
+            allocations[entry.name] += entry.allocations;
+        }
+        ++iterations;
+    }
+    for (auto& name : order)
+    {
+        bench.add("decompile/" + name + "/" + input.name, samples[name], 0, 0,
+                  static_cast<double>(allocations[name]) / samples[name].size());
+    }
+}
+
+void benchPscCoder(Bench& bench, const Input& input)
+{
+    bench.run("psc_coder/" + input.name, 0, 1, [&]() {
+        auto writer = new NullWriter();
+        Decompiler::PscCoder coder(writer);
+        coder.code(input.binary);
+    });
+}
+
+void benchAsmCoder(Bench& bench, const Input& input)
+{
+    bench.run("asm_coder/" + input.name, 0, 1, [&]() {
+        auto writer = new NullWriter();
+        Decompiler::AsmCoder coder(writer);
+        coder.code(input.binary);
+    });
+}
+
+bool getProgramOptions(int argc, char* argv[], Params& params)
+{
+    options::options_description desc("Champollion micro benchmarks");
+    desc.add_options()
+            ("help,h", "Display the help message")
+            ("filter,f", options::value<std::string>(), "Only run the benchmarks whose name contains this text")
+            ("min-time", options::value<size_t>(), "Minimum time spent in each benchmark, in milliseconds (default 200)")
+            ("output,o", options::value<std::string>(), "Write the JSON results to this file instead of the standard output");
+    options::variables_map args;
+    try
+    {
+        options::store(options::parse_command_line(argc, argv, desc), args);
+        options::notify(args);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << desc << std::endl;
+        return false;
+    }
+    if (args.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return false;
+    }
+    if (args.count("filter"))
+    {
+        params.filter = args["filter"].as<std::string>();
+    }
+    if (args.count("min-time"))
+    {
+        params.minTime = std::chrono::milliseconds(args["min-time"].as<size_t>());
+    }
+    if (args.count("output"))
+    {
+        params.output = args["output"].as<std::string>();
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    Params params;
+    if (!getProgramOptions(argc, argv, params))
+    {
+        return 1;
+    }
+    AllocationCounter::enable();
+    Decompiler::PassProfile::setAllocationCounter(AllocationCounter::count);
+
+    // Small, medium and huge scripts, from a short Skyrim script to a large Fallout 4 quest script
+    std::vector<Input> inputs(3);
+    Tools::Generator::Params shape;
+    shape.seed = 1;
+    shape.functions = 4;
+    shape.instructions = 40;
+    shape.depth = 2;
+    makeInput(inputs[0], "small", shape);
+    shape.seed = 2;
+    shape.game = Pex::Binary::Fallout4Script;
+    shape.functions = 40;
+    shape.instructions = 300;
+    shape.depth = 3;
+    makeInput(inputs[1], "medium", shape);
+    shape.seed = 3;
+    shape.functions = 50;
+    shape.instructions = 2000;
+    shape.depth = 4;
+    makeInput(inputs[2], "huge", shape);
+
+    Bench bench(params);
+    for (auto& input : inputs)
+    {
+        benchRead(bench, input);
+    }
+    benchStringTable(bench, inputs[2]);
+    benchValue(bench, inputs[1]);
+    for (auto& input : inputs)
+    {
+        benchPasses(bench, input);
+    }
+    benchPscCoder(bench, inputs[1]);
+    benchAsmCoder(bench, inputs[1]);
+
+    if (params.output.empty())
+    {
+        bench.write(std::cout);
+    }
+    else
+    {
+        std::ofstream file(params.output);
+        bench.write(file);
+    }
+    return 0;
+}
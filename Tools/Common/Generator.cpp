@@ -0,0 +1,1052 @@
+#include "Generator.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include "Pex/FileWriter.hpp"
+
+namespace {
+
+const size_t TRIVIAL_SHAPES = 14;
+
+enum class Type
+{
+    Int,
+    Float,
+    Bool,
+    String
+};
+
+const char* typeName(Type type)
+{
+    switch (type)
+    {
+    case Type::Int:
+        return "int";
+    case Type::Float:
+        return "float";
+    case Type::Bool:
+        return "bool";
+    default:
+        return "string";
+    }
+}
+
+/**
+ * @brief Features of the object available to the functions.
+ */
+struct Features
+{
+    std::vector<std::string> guards;
+    std::string structType;
+};
+
+/**
+ * @brief Name, parameters and result of a function, shared by its overrides in the states.
+ */
+struct Signature
+{
+    std::string name;
+    bool hasResult;
+    Type result;
+    std::vector<std::pair<std::string, Type>> params;
+};
+
+/**
+ * @brief Build the body of a function.
+ *
+ * The instructions follow the patterns of the Papyrus compiler. Temporaries are reused from
+ * one top level statement to the next, so the number of locals stays small whatever the
+ * size of the function.
+ */
+class FunctionBuilder
+{
+public:
+    FunctionBuilder(Tools::Generator& generator, Pex::Function& function, std::uint16_t line,
+                    const Features* features = nullptr) :
+        m_Generator(generator),
+        m_Function(function),
+        m_Line(line),
+        m_Features(features)
+    {
+        addLocal("::nonevar", "none");
+    }
+
+    void addParam(const std::string& name, Type type)
+    {
+        Pex::TypedName param;
+        param.setName(m_Generator.intern(name));
+        param.setTypeName(m_Generator.intern(typeName(type)));
+        m_Function.getParams().push_back(param);
+        m_Named.emplace_back(name, type);
+    }
+
+    void addVariable(const std::string& name, Type type)
+    {
+        addLocal(name, typeName(type));
+        m_Named.emplace_back(name, type);
+        advanceLine(1);
+        beginStatement();
+        emit(Pex::OpCode::ASSIGN, {id(name), literal(type)});
+    }
+
+    // Create a struct in a local, used by the following statements
+    void addStruct()
+    {
+        if (m_Features == nullptr || m_Features->structType.empty())
+        {
+            return;
+        }
+        m_Struct = "s0";
+        addLocal(m_Struct, m_Features->structType);
+        advanceLine(1);
+        emit(Pex::OpCode::STRUCT_CREATE, {id(m_Struct)});
+    }
+
+    void body(size_t instructions, size_t depth)
+    {
+        while (m_Function.getInstructions().size() < instructions)
+        {
+            beginStatement();
+            statement(depth);
+        }
+    }
+
+    // if/elseif chain on the first parameter, the same code as nested if/else
+    void chain(size_t length)
+    {
+        std::vector<size_t> ends;
+        for (size_t i = 0; i < length && next() < 59000; ++i)
+        {
+            advanceLine(1);
+            beginStatement();
+            auto condition = temp(Type::Bool);
+            emit(Pex::OpCode::CMP_EQ, {condition, id(m_Named[0].first), Pex::Value(static_cast<std::int32_t>(i))});
+            auto jump = emit(Pex::OpCode::JMPF, {condition, Pex::Value(0)});
+            advanceLine(1);
+            emit(Pex::OpCode::CALLMETHOD, {id("DoThing"), id("self"), id("::nonevar")},
+                 {Pex::Value(static_cast<std::int32_t>(i)), Pex::Value(true)});
+            ends.push_back(emit(Pex::OpCode::JMP, {Pex::Value(0)}));
+            setJump(jump, 1, next());
+        }
+        advanceLine(1);
+        emit(Pex::OpCode::CALLMETHOD, {id("Reset"), id("self"), id("::nonevar")});
+        for (auto end : ends)
+        {
+            setJump(end, 0, next());
+        }
+    }
+
+    void returnValue(Type type)
+    {
+        advanceLine(1);
+        beginStatement();
+        emit(Pex::OpCode::RETURN, {expression(type, 1)});
+    }
+
+    // Short bodies: empty functions, getters, setters and single calls, in TRIVIAL_SHAPES variants
+    void trivial(size_t shape)
+    {
+        static const Type types[] = {Type::Int, Type::Float, Type::Bool, Type::String};
+        auto setResult = [this](const char* type) {
+            m_Function.setReturnTypeName(m_Generator.intern(type));
+        };
+        setResult("none");
+        switch (shape)
+        {
+        case 0:
+            break;
+        case 1:
+        {
+            auto type = types[m_Generator.random(4)];
+            setResult(typeName(type));
+            emit(Pex::OpCode::RETURN, {literal(type)});
+            break;
+        }
+        case 2:
+            setResult("int");
+            addParam("p0", Type::Int);
+            emit(Pex::OpCode::RETURN, {id("p0")});
+            break;
+        case 3:
+            emit(Pex::OpCode::RETURN, {Pex::Value()});
+            break;
+        case 4:
+        case 5:
+            addParam("value", Type::Int);
+            emit(Pex::OpCode::ASSIGN, {id("::Total_var"), id("value")});
+            if (shape == 5)
+            {
+                advanceLine(1);
+                emit(Pex::OpCode::RETURN, {Pex::Value()});
+            }
+            break;
+        case 6:
+        {
+            setResult("int");
+            auto result = temp(Type::Int);
+            emit(Pex::OpCode::CALLMETHOD, {id("GetIntValue"), id("self"), result}, {literal(Type::Int)});
+            emit(Pex::OpCode::RETURN, {result});
+            break;
+        }
+        case 7:
+        case 8:
+            emit(Pex::OpCode::CALLMETHOD, {id("DoThing"), id("self"), id("::nonevar")},
+                 {literal(Type::Int), literal(Type::Bool)});
+            if (shape == 8)
+            {
+                advanceLine(1);
+                emit(Pex::OpCode::RETURN, {Pex::Value()});
+            }
+            break;
+        case 9:
+            setResult("int");
+            emit(Pex::OpCode::CALLMETHOD, {id("GetIntValue"), id("self"), id("::Total_var")}, {literal(Type::Int)});
+            advanceLine(1);
+            emit(Pex::OpCode::RETURN, {id("::Total_var")});
+            break;
+        case 10:
+            setResult("bool");
+            emit(Pex::OpCode::CALLMETHOD, {id("IsReady"), id("self"), temp(Type::Bool)});
+            advanceLine(1);
+            emit(Pex::OpCode::RETURN, {literal(Type::Bool)});
+            break;
+        case 11:
+        {
+            setResult("int");
+            auto result = temp(Type::Int);
+            emit(Pex::OpCode::ASSIGN, {result, literal(Type::Int)});
+            emit(Pex::OpCode::RETURN, {result});
+            break;
+        }
+        case 12:
+            setResult("int");
+            addLocal("v0", "int");
+            emit(Pex::OpCode::ASSIGN, {id("v0"), literal(Type::Int)});
+            advanceLine(1);
+            emit(Pex::OpCode::RETURN, {id("v0")});
+            break;
+        default:
+            emit(Pex::OpCode::RETURN, {id("::nonevar")});
+            break;
+        }
+    }
+
+    size_t emit(Pex::OpCode opcode, std::initializer_list<Pex::Value> args, std::vector<Pex::Value> varargs = {})
+    {
+        Pex::Instruction instruction;
+        instruction.setOpCode(opcode);
+        instruction.getArgs().assign(args);
+        if (instruction.hasVarArgs())
+        {
+            instruction.getVarArgs() = std::move(varargs);
+        }
+        m_Function.getInstructions().push_back(std::move(instruction));
+        m_Lines.push_back(m_Line);
+        return m_Function.getInstructions().size() - 1;
+    }
+
+    Pex::Value id(const std::string& name)
+    {
+        return Pex::Value(m_Generator.intern(name), true);
+    }
+
+    const std::vector<std::uint16_t>& getLines() const
+    {
+        return m_Lines;
+    }
+
+protected:
+    void addLocal(const std::string& name, const std::string& type)
+    {
+        Pex::TypedName local;
+        local.setName(m_Generator.intern(name));
+        local.setTypeName(m_Generator.intern(type));
+        m_Function.getLocals().push_back(local);
+    }
+
+    // Line numbers are stored on 16 bits, the last line is repeated once reached
+    void advanceLine(std::uint16_t count)
+    {
+        m_Line = static_cast<std::uint16_t>(std::min<int>(m_Line + count, 0xFFFF));
+    }
+
+    void beginStatement()
+    {
+        m_TempsInUse.clear();
+    }
+
+    Pex::Value temp(Type type)
+    {
+        auto& temps = m_Temps[type];
+        auto& used = m_TempsInUse[type];
+        if (used == temps.size())
+        {
+            auto name = "::temp" + std::to_string(m_TempCount++);
+            addLocal(name, typeName(type));
+            temps.push_back(name);
+        }
+        return id(temps[used++]);
+    }
+
+    void setJump(size_t ip, size_t arg, size_t target)
+    {
+        auto offset = static_cast<std::int32_t>(target) - static_cast<std::int32_t>(ip);
+        m_Function.getInstructions()[ip].getArgs()[arg] = Pex::Value(offset);
+    }
+
+    size_t next() const
+    {
+        return m_Function.getInstructions().size();
+    }
+
+    Pex::Value literal(Type type)
+    {
+        static const float floats[] = {0.0f, 1.5f, 0.25f, 3.0f, -2.75f, 100.0f, 0.1f, 1e-3f, 12345.678f};
+        static const char* strings[] = {"hello", "a\"b", "line\nnext", "tab\there", "back\\slash", ""};
+        switch (type)
+        {
+        case Type::Int:
+            return Pex::Value(static_cast<std::int32_t>(m_Generator.random(1006)) - 5);
+        case Type::Float:
+            return Pex::Value(floats[m_Generator.random(9)]);
+        case Type::Bool:
+            return Pex::Value(m_Generator.random(2) == 0);
+        default:
+            return Pex::Value(m_Generator.intern(strings[m_Generator.random(6)]));
+        }
+    }
+
+    Pex::Value variableOf(Type type)
+    {
+        std::vector<const std::string*> candidates;
+        for (auto& named : m_Named)
+        {
+            if (named.second == type)
+            {
+                candidates.push_back(&named.first);
+            }
+        }
+        if (!candidates.empty() && m_Generator.random(10) < 7)
+        {
+            return id(*candidates[m_Generator.random(static_cast<std::uint32_t>(candidates.size()))]);
+        }
+        return literal(type);
+    }
+
+    Pex::Value expression(Type type, int depth)
+    {
+        if (depth <= 0 || m_Generator.random(10) < 3)
+        {
+            return variableOf(type);
+        }
+        auto kind = m_Generator.random(20);
+        switch (type)
+        {
+        case Type::Int:
+        case Type::Float:
+        {
+            bool isInt = type == Type::Int;
+            if (isInt && !m_Struct.empty() && m_Generator.random(8) == 0)
+            {
+                auto result = temp(type);
+                emit(Pex::OpCode::STRUCT_GET, {result, id(m_Struct), id("X")});
+                return result;
+            }
+            if (kind < 12)
+            {
+                static const Pex::OpCode intOps[] = {Pex::OpCode::IADD, Pex::OpCode::ISUB, Pex::OpCode::IMUL,
+                                                     Pex::OpCode::IDIV, Pex::OpCode::IMOD};
+                static const Pex::OpCode floatOps[] = {Pex::OpCode::FADD, Pex::OpCode::FSUB, Pex::OpCode::FMUL,
+                                                       Pex::OpCode::FDIV};
+                auto op = isInt ? intOps[m_Generator.random(5)] : floatOps[m_Generator.random(4)];
+                auto left = expression(type, depth - 1);
+                auto right = expression(type, depth - 1);
+                auto result = temp(type);
+                emit(op, {result, left, right});
+                return result;
+            }
+            if (kind < 15)
+            {
+                auto operand = expression(type, depth - 1);
+                auto result = temp(type);
+                emit(isInt ? Pex::OpCode::INEG : Pex::OpCode::FNEG, {result, operand});
+                return result;
+            }
+            if (kind < 18)
+            {
+                auto arg = expression(Type::Int, depth - 1);
+                auto result = temp(type);
+                emit(Pex::OpCode::CALLMETHOD, {id(isInt ? "GetIntValue" : "GetFloatValue"), id("self"), result}, {arg});
+                return result;
+            }
+            auto result = temp(type);
+            emit(Pex::OpCode::PROPGET, {id(isInt ? "Count" : "Ratio"), id("self"), result});
+            return result;
+        }
+        case Type::Bool:
+        {
+            if (kind < 10)
+            {
+                return comparison(depth);
+            }
+            if (kind < 15)
+            {
+                return booleanChain(depth);
+            }
+            if (kind < 17)
+            {
+                auto operand = comparison(depth - 1);
+                auto result = temp(Type::Bool);
+                emit(Pex::OpCode::NOT, {result, operand});
+                return result;
+            }
+            auto result = temp(Type::Bool);
+            emit(Pex::OpCode::CALLMETHOD, {id("IsReady"), id("self"), result});
+            return result;
+        }
+        default:
+        {
+            if (kind < 10)
+            {
+                auto left = expression(Type::String, depth - 1);
+                auto right = expression(Type::String, depth - 1);
+                auto result = temp(Type::String);
+                emit(Pex::OpCode::STRCAT, {result, left, right});
+                return result;
+            }
+            auto operand = expression(Type::Int, depth - 1);
+            auto result = temp(Type::String);
+            emit(Pex::OpCode::CAST, {result, operand});
+            return result;
+        }
+        }
+    }
+
+    Pex::Value comparison(int depth)
+    {
+        static const Pex::OpCode ops[] = {Pex::OpCode::CMP_EQ, Pex::OpCode::CMP_LT, Pex::OpCode::CMP_LTE,
+                                          Pex::OpCode::CMP_GT, Pex::OpCode::CMP_GTE};
+        auto type = m_Generator.random(2) == 0 ? Type::Int : Type::Float;
+        auto left = expression(type, depth - 1);
+        auto right = expression(type, depth - 1);
+        auto result = temp(Type::Bool);
+        emit(ops[m_Generator.random(5)], {result, left, right});
+        return result;
+    }
+
+    // a && b && c, or a || b || c: the result is assigned in place, the jumps skip to the end
+    Pex::Value booleanChain(int depth)
+    {
+        auto op = m_Generator.random(2) == 0 ? Pex::OpCode::JMPF : Pex::OpCode::JMPT;
+        auto count = 2 + m_Generator.random(2);
+        auto first = comparison(depth - 1);
+        for (std::uint32_t i = 1; i < count; ++i)
+        {
+            auto jump = emit(op, {first, Pex::Value(0)});
+            auto operand = comparison(depth - 1);
+            emit(Pex::OpCode::ASSIGN, {first, operand});
+            setJump(jump, 1, next());
+        }
+        return first;
+    }
+
+    void statement(size_t depth)
+    {
+        advanceLine(m_Generator.random(4) == 0 ? 2 : 1);
+        auto kind = m_Generator.random(50);
+        m_EndsWithLoop = false;
+        if (m_Features && !m_Features->guards.empty() && m_Generator.random(12) == 0)
+        {
+            guard();
+        }
+        else if (!m_Struct.empty() && m_Generator.random(12) == 0)
+        {
+            auto value = expression(Type::Int, 1);
+            emit(Pex::OpCode::STRUCT_SET, {id(m_Struct), id("X"), value});
+        }
+        else if (depth > 0 && kind < 9)
+        {
+            ifElse(depth);
+        }
+        else if (depth > 0 && kind < 13)
+        {
+            whileLoop(depth);
+        }
+        else if (kind < 28 && !m_Named.empty())
+        {
+            auto& named = m_Named[m_Generator.random(static_cast<std::uint32_t>(m_Named.size()))];
+            auto value = expression(named.second, 2);
+            emit(Pex::OpCode::ASSIGN, {id(named.first), value});
+        }
+        else if (kind < 35)
+        {
+            auto message = expression(Type::String, 1);
+            emit(Pex::OpCode::CALLSTATIC, {id("Debug"), id("Trace"), id("::nonevar")}, {message, Pex::Value(0)});
+        }
+        else if (kind < 40)
+        {
+            auto count = expression(Type::Int, 1);
+            auto flag = expression(Type::Bool, 1);
+            emit(Pex::OpCode::CALLMETHOD, {id("DoThing"), id("self"), id("::nonevar")}, {count, flag});
+        }
+        else if (kind < 44)
+        {
+            auto value = expression(Type::Int, 1);
+            emit(Pex::OpCode::PROPSET, {id("Count"), id("self"), value});
+        }
+        else
+        {
+            const std::string* counter = nullptr;
+            for (auto& named : m_Named)
+            {
+                if (named.second == Type::Int)
+                {
+                    counter = &named.first;
+                }
+            }
+            if (counter)
+            {
+                auto result = temp(Type::Int);
+                emit(Pex::OpCode::IADD, {result, id(*counter), Pex::Value(1)});
+                emit(Pex::OpCode::ASSIGN, {id(*counter), result});
+            }
+            else
+            {
+                emit(Pex::OpCode::CALLMETHOD, {id("Reset"), id("self"), id("::nonevar")});
+            }
+        }
+    }
+
+    void block(size_t depth)
+    {
+        auto count = 1 + m_Generator.random(3);
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            statement(depth - 1);
+        }
+        // The decompiler does not rebuild a loop exiting to the end of the enclosing if
+        if (m_EndsWithLoop)
+        {
+            emit(Pex::OpCode::CALLMETHOD, {id("Reset"), id("self"), id("::nonevar")});
+            m_EndsWithLoop = false;
+        }
+    }
+
+    void ifElse(size_t depth)
+    {
+        std::vector<size_t> ends;
+        auto elseIfs = std::max<std::uint32_t>(m_Generator.random(4), 1) - 1;
+        bool hasElse = m_Generator.random(2) == 0;
+        auto jump = emit(Pex::OpCode::JMPF, {expression(Type::Bool, 2), Pex::Value(0)});
+        block(depth);
+        for (std::uint32_t i = 0; i < elseIfs; ++i)
+        {
+            ends.push_back(emit(Pex::OpCode::JMP, {Pex::Value(0)}));
+            setJump(jump, 1, next());
+            advanceLine(1);
+            jump = emit(Pex::OpCode::JMPF, {expression(Type::Bool, 2), Pex::Value(0)});
+            block(depth);
+        }
+        if (hasElse)
+        {
+            ends.push_back(emit(Pex::OpCode::JMP, {Pex::Value(0)}));
+            setJump(jump, 1, next());
+            advanceLine(1);
+            block(depth);
+        }
+        else
+        {
+            setJump(jump, 1, next());
+        }
+        for (auto end : ends)
+        {
+            setJump(end, 0, next());
+        }
+        advanceLine(1);
+    }
+
+    // Guard or TryGuard block, the body is made of simple statements
+    void guard()
+    {
+        auto& guards = m_Features->guards;
+        auto count = 1 + m_Generator.random(std::min<std::uint32_t>(2, static_cast<std::uint32_t>(guards.size())));
+        auto first = m_Generator.random(static_cast<std::uint32_t>(guards.size()));
+        std::vector<Pex::Value> names;
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            names.push_back(id(guards[(first + i) % guards.size()]));
+        }
+        if (m_Generator.random(3) == 0)
+        {
+            auto locked = temp(Type::Bool);
+            emit(Pex::OpCode::TRY_LOCK_GUARDS, {locked}, names);
+            auto jump = emit(Pex::OpCode::JMPF, {locked, Pex::Value(0)});
+            block(1);
+            emit(Pex::OpCode::UNLOCK_GUARDS, {}, names);
+            setJump(jump, 1, next());
+        }
+        else
+        {
+            emit(Pex::OpCode::LOCK_GUARDS, {}, names);
+            block(1);
+            emit(Pex::OpCode::UNLOCK_GUARDS, {}, names);
+        }
+        advanceLine(1);
+    }
+
+    void whileLoop(size_t depth)
+    {
+        auto top = next();
+        auto jump = emit(Pex::OpCode::JMPF, {expression(Type::Bool, 1), Pex::Value(0)});
+        block(depth);
+        auto back = emit(Pex::OpCode::JMP, {Pex::Value(0)});
+        setJump(back, 0, top);
+        setJump(jump, 1, next());
+        advanceLine(1);
+        m_EndsWithLoop = true;
+    }
+
+    Tools::Generator& m_Generator;
+    Pex::Function& m_Function;
+    std::uint16_t m_Line;
+    const Features* m_Features;
+    std::string m_Struct;
+    std::vector<std::uint16_t> m_Lines;
+    std::vector<std::pair<std::string, Type>> m_Named;
+    std::map<Type, std::vector<std::string>> m_Temps;
+    std::map<Type, size_t> m_TempsInUse;
+    size_t m_TempCount = 0;
+    bool m_EndsWithLoop = false;
+};
+
+}
+
+
+/**
+ * @brief Constructor
+ * @param params Shape of the scripts to generate.
+ */
+Tools::Generator::Generator(const Params &params) :
+    m_Params(params),
+    m_Random(params.seed),
+    m_Table(nullptr)
+{
+    // The instruction count of a function is stored on 16 bits
+    m_Params.instructions = std::min<size_t>(m_Params.instructions, 60000);
+    m_Params.chain = std::min<size_t>(m_Params.chain, 10000);
+    m_Params.strings = std::min<size_t>(m_Params.strings, 0xFFFF);
+    m_Params.objects = std::max<size_t>(m_Params.objects, 1);
+    m_Params.states = std::max<size_t>(m_Params.states, 1);
+    // Guards are only known by Starfield, structs by Fallout 4 and Starfield
+    if (m_Params.game != Pex::Binary::StarfieldScript)
+    {
+        m_Params.guards = 0;
+    }
+    if (m_Params.game == Pex::Binary::SkyrimScript)
+    {
+        m_Params.structs = 0;
+    }
+}
+
+/**
+ * @brief Generate a script.
+ * @param[out] binary Binary receiving the script. It must be empty.
+ */
+void Tools::Generator::generate(Pex::Binary &binary)
+{
+    m_Table = &binary.getStringTable();
+    m_Strings.clear();
+    binary.setScriptType(m_Params.game);
+    generateHeader(binary);
+
+    Pex::UserFlag hidden;
+    hidden.setName(intern("hidden"));
+    hidden.setFlagIndex(0);
+    binary.getUserFlags().push_back(hidden);
+    Pex::UserFlag conditional;
+    conditional.setName(intern("conditional"));
+    conditional.setFlagIndex(1);
+    binary.getUserFlags().push_back(conditional);
+
+    auto& objects = binary.getObjects();
+    objects.reserve(m_Params.objects);
+    for (size_t i = 0; i < m_Params.objects; ++i)
+    {
+        objects.emplace_back();
+        generateObject(binary, objects.back(), i);
+    }
+
+    // Strings nobody references, for the string table lookups
+    for (size_t i = 0; m_Table->size() < m_Params.strings; ++i)
+    {
+        intern("Unused" + std::to_string(i));
+    }
+}
+
+/**
+ * @brief Serialize a binary in the PEX format.
+ * @param binary Binary to serialize.
+ * @return The content of the PEX file.
+ */
+std::string Tools::Generator::toBytes(const Pex::Binary &binary)
+{
+    std::ostringstream stream(std::ios::binary);
+    Pex::FileWriter writer(&stream);
+    writer.write(binary);
+    return stream.str();
+}
+
+/**
+ * @brief Write a corpus of scripts.
+ * The files are named gen00000.pex, gen00001.pex... and use the seeds following the seed of the parameters.
+ *
+ * @param dir Directory receiving the files, created if needed.
+ * @param params Shape of the scripts.
+ * @param files Number of files to write.
+ * @param mixed True to cycle through Skyrim, Fallout 4 and Starfield instead of the game of the parameters.
+ * @return The total size of the files, in bytes.
+ */
+size_t Tools::Generator::writeCorpus(const std::filesystem::path &dir, const Params &params, size_t files, bool mixed)
+{
+    static const Pex::Binary::ScriptType games[] = {Pex::Binary::SkyrimScript, Pex::Binary::Fallout4Script,
+                                                    Pex::Binary::StarfieldScript};
+    std::filesystem::create_directories(dir);
+    size_t bytes = 0;
+    for (size_t i = 0; i < files; ++i)
+    {
+        auto shape = params;
+        shape.seed += static_cast<std::uint32_t>(i);
+        if (mixed)
+        {
+            shape.game = games[i % 3];
+        }
+        char name[32];
+        std::snprintf(name, sizeof(name), "gen%05zu.pex", i);
+        auto path = dir / name;
+
+        Pex::Binary binary;
+        Generator generator(shape);
+        generator.generate(binary);
+        auto content = toBytes(binary);
+        std::ofstream file(path, std::ios::binary);
+        file.write(content.data(), content.size());
+        if (!file)
+        {
+            throw std::runtime_error("Unable to write " + path.string());
+        }
+        bytes += content.size();
+    }
+    return bytes;
+}
+
+/**
+ * @brief Draw a random number.
+ * The modulo of the raw engine output is used, the standard distributions are not portable.
+ *
+ * @param count Number of possible values.
+ * @return A number in [0, count).
+ */
+std::uint32_t Tools::Generator::random(std::uint32_t count)
+{
+    return static_cast<std::uint32_t>(m_Random() % count);
+}
+
+/**
+ * @brief Get the index of a string, adding it to the string table if needed.
+ * @param value String to find.
+ * @return The index of the string.
+ */
+Pex::StringTable::Index Tools::Generator::intern(const std::string &value)
+{
+    auto it = m_Strings.find(value);
+    if (it == m_Strings.end())
+    {
+        if (m_Table->size() >= 0xFFFF)
+        {
+            throw std::runtime_error("The string table is full");
+        }
+        it = m_Strings.emplace(value, static_cast<std::uint16_t>(m_Table->size())).first;
+        m_Table->push_back(value);
+    }
+    return m_Table->get(it->second);
+}
+
+/**
+ * @brief Fill the header with the version of the game.
+ * @param binary Binary to fill in.
+ */
+void Tools::Generator::generateHeader(Pex::Binary &binary)
+{
+    auto& header = binary.getHeader();
+    header.setMajorVersion(3);
+    switch (m_Params.game)
+    {
+    case Pex::Binary::SkyrimScript:
+        header.setMinorVersion(2);
+        header.setGameID(1);
+        break;
+    case Pex::Binary::Fallout4Script:
+        header.setMinorVersion(9);
+        header.setGameID(2);
+        break;
+    default:
+        header.setMinorVersion(12);
+        header.setGameID(4);
+        break;
+    }
+    header.setCompilationTime(1700000000 + m_Params.seed);
+    header.setUserName("user");
+    header.setComputerName("machine");
+    binary.getDebugInfo().setModificationTime(1690000000 + m_Params.seed);
+}
+
+/**
+ * @brief Generate an object of the script.
+ * @param binary Binary containing the object.
+ * @param object Object to fill in.
+ * @param index Index of the object in the script.
+ */
+void Tools::Generator::generateObject(Pex::Binary &binary, Pex::Object &object, size_t index)
+{
+    static const char* games[] = {"Skyrim", "Fallout4", "Starfield"};
+    static const char* names[] = {"OnInit", "OnActivate", "DoWork", "Compute", "Helper", "OnUpdate",
+                                  "Process", "Check", "Run", "Tick", "Update", "Apply"};
+    static const Type types[] = {Type::Int, Type::Float, Type::Bool, Type::String};
+
+    auto objectName = std::string("Gen") + games[m_Params.game] + std::to_string(m_Params.seed);
+    if (index == 0)
+    {
+        binary.getHeader().setSourceFileName(objectName + ".psc");
+    }
+    else
+    {
+        objectName += "_" + std::to_string(index);
+    }
+    object.setName(intern(objectName));
+    object.setParentClassName(intern("ObjectReference"));
+    object.setDocString(intern("generated"));
+    object.setAutoStateName(intern(""));
+    auto none = intern("none");
+    auto defaultState = intern("");
+
+    Features features;
+    for (size_t g = 0; g < m_Params.guards; ++g)
+    {
+        features.guards.push_back("Lock" + std::to_string(g));
+        Pex::Guard guard;
+        guard.setName(intern(features.guards.back()));
+        object.getGuards().push_back(guard);
+    }
+    for (size_t s = 0; s < m_Params.structs; ++s)
+    {
+        auto structName = "Point" + std::to_string(s);
+        Pex::StructInfo info;
+        info.setName(intern(structName));
+        Pex::DebugInfo::StructOrder order;
+        order.setObjectName(object.getName());
+        order.setOrderName(info.getName());
+        for (auto type : {Type::Int, Type::Float})
+        {
+            Pex::StructInfo::Member member;
+            member.setName(intern(type == Type::Int ? "X" : "Y"));
+            member.setTypeName(intern(typeName(type)));
+            member.setUserFlags(0);
+            member.setConstFlag(0);
+            member.setDocString(defaultState);
+            member.setValue(type == Type::Int ? Pex::Value(std::int32_t(s)) : Pex::Value(0.5f));
+            order.getNames().push_back(member.getName());
+            info.getMembers().push_back(member);
+        }
+        object.getStructInfos().push_back(info);
+        binary.getDebugInfo().getStructOrders().push_back(order);
+    }
+    if (m_Params.structs != 0)
+    {
+        features.structType = objectName + "#Point0";
+    }
+
+    Pex::Variable total;
+    total.setName(intern("::Total_var"));
+    total.setTypeName(intern("int"));
+    total.setDefaultValue(Pex::Value(std::int32_t(5)));
+    object.getVariables().push_back(total);
+    Pex::Variable ratio;
+    ratio.setName(intern("myFloat"));
+    ratio.setTypeName(intern("float"));
+    ratio.setDefaultValue(Pex::Value(2.5f));
+    object.getVariables().push_back(ratio);
+
+    Pex::Property autoProperty;
+    autoProperty.setName(intern("Auto1"));
+    autoProperty.setTypeName(intern("int"));
+    autoProperty.setDocString(defaultState);
+    autoProperty.setUserFlags(1);
+    autoProperty.setFlags(Pex::PropertyFlag::READ | Pex::PropertyFlag::WRITE | Pex::PropertyFlag::AUTOVAR);
+    autoProperty.setAutoVarName(intern("::Total_var"));
+    object.getProperties().push_back(autoProperty);
+
+    Pex::Property fullProperty;
+    fullProperty.setName(intern("Total"));
+    fullProperty.setTypeName(intern("int"));
+    fullProperty.setDocString(intern("doc"));
+    fullProperty.setFlags(Pex::PropertyFlag::READ | Pex::PropertyFlag::WRITE);
+    {
+        auto& getter = fullProperty.getReadFunction();
+        getter.setReturnTypeName(intern("int"));
+        getter.setDocString(defaultState);
+        FunctionBuilder builder(*this, getter, 5);
+        builder.emit(Pex::OpCode::RETURN, {builder.id("::Total_var")});
+        addFunctionInfo(binary, object, defaultState, fullProperty.getName(), Pex::DebugInfo::FunctionType::Getter,
+                        builder.getLines());
+    }
+    {
+        auto& setter = fullProperty.getWriteFunction();
+        setter.setReturnTypeName(none);
+        setter.setDocString(defaultState);
+        FunctionBuilder builder(*this, setter, 7);
+        builder.addParam("value", Type::Int);
+        builder.emit(Pex::OpCode::ASSIGN, {builder.id("::Total_var"), builder.id("value")});
+        addFunctionInfo(binary, object, defaultState, fullProperty.getName(), Pex::DebugInfo::FunctionType::Setter,
+                        builder.getLines());
+    }
+    object.getProperties().push_back(fullProperty);
+
+    // Line numbers are stored on 16 bits, the functions of huge scripts share the lines
+    std::uint16_t line = 10;
+    auto nextLine = [&line](const FunctionBuilder& builder) {
+        line = builder.getLines().back() < 0xF000 ? builder.getLines().back() + 3 : 10;
+    };
+    auto build = [&](const Signature& signature, const Pex::StringTable::Index& state, size_t instructions,
+                     size_t depth) {
+        Pex::Function function;
+        function.setName(intern(signature.name));
+        function.setReturnTypeName(signature.hasResult ? intern(typeName(signature.result)) : none);
+        function.setDocString(defaultState);
+
+        FunctionBuilder builder(*this, function, line, &features);
+        for (auto& param : signature.params)
+        {
+            builder.addParam(param.first, param.second);
+        }
+        auto locals = random(4);
+        for (std::uint32_t v = 0; v < locals; ++v)
+        {
+            builder.addVariable("v" + std::to_string(v), types[random(4)]);
+        }
+        builder.addStruct();
+        builder.body(instructions, depth);
+        if (signature.hasResult)
+        {
+            builder.returnValue(signature.result);
+        }
+        addFunctionInfo(binary, object, state, function.getName(), Pex::DebugInfo::FunctionType::Method,
+                        builder.getLines());
+        nextLine(builder);
+        return function;
+    };
+
+    auto& states = object.getStates();
+    states.reserve(m_Params.states + 1);
+    states.emplace_back();
+    states.back().setName(defaultState);
+    std::vector<Signature> signatures;
+    for (size_t i = 0; i < m_Params.functions; ++i)
+    {
+        Signature signature;
+        signature.name = std::string(names[i % 12]) + (i < 12 ? "" : std::to_string(i));
+        bool isEvent = signature.name.compare(0, 2, "On") == 0;
+        signature.hasResult = !isEvent && random(3) != 0;
+        signature.result = types[random(4)];
+        auto params = random(4);
+        for (std::uint32_t p = 0; p < params; ++p)
+        {
+            signature.params.emplace_back("p" + std::to_string(p), types[random(4)]);
+        }
+        states.back().getFunctions().push_back(build(signature, defaultState, m_Params.instructions,
+                                                     m_Params.depth));
+        signatures.push_back(std::move(signature));
+    }
+
+    if (m_Params.chain != 0)
+    {
+        Pex::Function function;
+        function.setName(intern("DeepChain"));
+        function.setReturnTypeName(none);
+        function.setDocString(defaultState);
+        FunctionBuilder builder(*this, function, line);
+        builder.addParam("p0", Type::Int);
+        builder.chain(m_Params.chain);
+        addFunctionInfo(binary, object, defaultState, function.getName(), Pex::DebugInfo::FunctionType::Method,
+                        builder.getLines());
+        nextLine(builder);
+        states.back().getFunctions().push_back(std::move(function));
+    }
+
+    Pex::Function native;
+    native.setName(intern("NativeThing"));
+    native.setReturnTypeName(intern("int"));
+    native.setDocString(defaultState);
+    native.setFlags(0x02);
+    states.back().getFunctions().push_back(native);
+
+    for (size_t i = 0; i < m_Params.trivial; ++i)
+    {
+        Pex::Function function;
+        function.setName(intern("Trivial" + std::to_string(i)));
+        function.setDocString(defaultState);
+        FunctionBuilder builder(*this, function, line);
+        builder.trivial(i % TRIVIAL_SHAPES);
+        addFunctionInfo(binary, object, defaultState, function.getName(), Pex::DebugInfo::FunctionType::Method,
+                        builder.getLines());
+        if (!builder.getLines().empty())
+        {
+            nextLine(builder);
+        }
+        states.back().getFunctions().push_back(std::move(function));
+    }
+
+    // Named states, each with an OnBeginState event and the overrides of a few functions
+    for (size_t s = 0; s < m_Params.states; ++s)
+    {
+        states.emplace_back();
+        auto stateName = intern(s == 0 ? std::string("Busy") : "State" + std::to_string(s));
+        states.back().setName(stateName);
+        Signature onBegin;
+        onBegin.name = "OnBeginState";
+        onBegin.hasResult = false;
+        states.back().getFunctions().push_back(build(onBegin, stateName, 8, 2));
+        for (size_t i = 0; i < 2 && i < signatures.size(); ++i)
+        {
+            auto& signature = signatures[(s + i) % signatures.size()];
+            states.back().getFunctions().push_back(build(signature, stateName,
+                                                         std::min<size_t>(m_Params.instructions, 40), 2));
+        }
+    }
+}
+
+/**
+ * @brief Add the debug info of a function.
+ * @param binary Binary containing the debug info.
+ * @param object Object of the function.
+ * @param state State of the function.
+ * @param name Name of the function.
+ * @param type Type of the function.
+ * @param lines Line number of each instruction.
+ */
+void Tools::Generator::addFunctionInfo(Pex::Binary &binary, const Pex::Object &object,
+                                       const Pex::StringTable::Index &state, const Pex::StringTable::Index &name,
+                                       Pex::DebugInfo::FunctionType type, const std::vector<std::uint16_t> &lines)
+{
+    Pex::DebugInfo::FunctionInfo info;
+    info.setObjectName(object.getName());
+    info.setStateName(state);
+    info.setFunctionName(name);
+    info.setFunctionType(type);
+    info.getLineNumbers().assign(lines.begin(), lines.end());
+    binary.getDebugInfo().getFunctionInfos().push_back(info);
+}
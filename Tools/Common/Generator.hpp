@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include "Pex/Binary.hpp"
+
+namespace Tools {
+
+/**
+ * @brief Deterministic synthetic PEX generator.
+ *
+ * The Generator builds a script from a seed and size parameters. The functions are made of
+ * the instruction patterns emitted by the Papyrus compiler: expressions through temporaries,
+ * if/elseif/else, while loops and short-circuit boolean operators. The same parameters always
+ * produce the same binary, whatever the platform.
+ *
+ * Besides the size of the functions, the parameters control the number of objects and states,
+ * the minimum size of the string table, the guards (Starfield) and the structs (Fallout 4 and
+ * Starfield) of the objects, the length of an if/elseif chain in a DeepChain function and the
+ * number of trivial functions: empty bodies, getters, setters and single calls.
+ */
+class Generator
+{
+public:
+    struct Params
+    {
+        Pex::Binary::ScriptType game = Pex::Binary::SkyrimScript;
+        std::uint32_t seed = 0;
+        size_t functions = 8;
+        size_t instructions = 100;
+        size_t depth = 3;
+        size_t objects = 1;
+        size_t states = 1;
+        size_t strings = 0;
+        size_t guards = 0;
+        size_t structs = 0;
+        size_t chain = 0;
+        size_t trivial = 0;
+    };
+
+    explicit Generator(const Params& params);
+
+    void generate(Pex::Binary& binary);
+    static std::string toBytes(const Pex::Binary& binary);
+    static size_t writeCorpus(const std::filesystem::path& dir, const Params& params, size_t files, bool mixed);
+
+    std::uint32_t random(std::uint32_t count);
+    Pex::StringTable::Index intern(const std::string& value);
+
+protected:
+    void generateHeader(Pex::Binary& binary);
+    void generateObject(Pex::Binary& binary, Pex::Object& object, size_t index);
+    void addFunctionInfo(Pex::Binary& binary, const Pex::Object& object, const Pex::StringTable::Index& state,
+                         const Pex::StringTable::Index& name, Pex::DebugInfo::FunctionType type,
+                         const std::vector<std::uint16_t>& lines);
+
+    Params m_Params;
+    std::mt19937 m_Random;
+    Pex::StringTable* m_Table;
+    std::unordered_map<std::string, std::uint16_t> m_Strings;
+};
+
+}
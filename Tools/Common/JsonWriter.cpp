@@ -0,0 +1,255 @@
+#include "JsonWriter.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+/**
+ * @brief Constructor
+ * @param stream Stream receiving the JSON text.
+ */
+Tools::JsonWriter::JsonWriter(std::ostream &stream) :
+    m_Stream(stream),
+    m_AfterKey(false)
+{
+}
+
+/**
+ * @brief Destructor
+ * Ends the last line of the document.
+ */
+Tools::JsonWriter::~JsonWriter()
+{
+    m_Stream << '\n';
+}
+
+/**
+ * @brief Open an object.
+ * @return A reference to this.
+ */
+Tools::JsonWriter &Tools::JsonWriter::beginObject()
+{
+    separate();
+    m_Stream << '{';
+    m_First.push_back(true);
+    return *this;
+}
+
+/**
+ * @brief Close the current object.
+ * @return A reference to this.
+ */
+Tools::JsonWriter &Tools::JsonWriter::endObject()
+{
+    close('}');
+    return *this;
+}
+
+/**
+ * @brief Open an array.
+ * @return A reference to this.
+ */
+Tools::JsonWriter &Tools::JsonWriter::beginArray()
+{
+    separate();
+    m_Stream << '[';
+    m_First.push_back(true);
+    return *this;
+}
+
+/**
+ * @brief Close the current array.
+ * @return A reference to this.
+ */
+Tools::JsonWriter &Tools::JsonWriter::endArray()
+{
+    close(']');
+    return *this;
+}
+
+/**
+ * @brief Write the name of the next member of the current object.
+ * @param name Name of the member.
+ * @return A reference to this.
+ */
+Tools::JsonWriter &Tools::JsonWriter::key(std::string_view name)
+{
+    separate();
+    writeString(name);
+    m_Stream << ": ";
+    m_AfterKey = true;
+    return *this;
+}
+
+/**
+ * @brief Write a string.
+ * @param text String to write.
+ * @return A reference to this.
+ */
+Tools::JsonWriter &Tools::JsonWriter::value(std::string_view text)
+{
+    separate();
+    writeString(text);
+    return *this;
+}
+
+/**
+ * @brief Write a string.
+ * @param text String to write.
+ * @return A reference to this.
+ */
+Tools::JsonWriter &Tools::JsonWriter::value(const char *text)
+{
+    return value(std::string_view(text));
+}
+
+/**
+ * @brief Write a floating point number.
+ * JSON has no infinity nor NaN, they are written as null.
+ *
+ * @param number Number to write.
+ * @return A reference to this.
+ */
+Tools::JsonWriter &Tools::JsonWriter::value(double number)
+{
+    separate();
+    if (std::isfinite(number))
+    {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.17g", number);
+        m_Stream << text;
+    }
+    else
+    {
+        m_Stream << "null";
+    }
+    return *this;
+}
+
+/**
+ * @brief Write an unsigned integer.
+ * @param number Number to write.
+ * @return A reference to this.
+ */
+Tools::JsonWriter &Tools::JsonWriter::value(std::uint64_t number)
+{
+    separate();
+    m_Stream << number;
+    return *this;
+}
+
+/**
+ * @brief Write a signed integer.
+ * @param number Number to write.
+ * @return A reference to this.
+ */
+Tools::JsonWriter &Tools::JsonWriter::value(std::int64_t number)
+{
+    separate();
+    m_Stream << number;
+    return *this;
+}
+
+/**
+ * @brief Write a boolean.
+ * @param flag Boolean to write.
+ * @return A reference to this.
+ */
+Tools::JsonWriter &Tools::JsonWriter::value(bool flag)
+{
+    separate();
+    m_Stream << (flag ? "true" : "false");
+    return *this;
+}
+
+/**
+ * @brief Write the separator preceding a value.
+ * Nothing is written between a key and its value.
+ */
+void Tools::JsonWriter::separate()
+{
+    if (m_AfterKey)
+    {
+        m_AfterKey = false;
+        return;
+    }
+    if (m_First.empty())
+    {
+        return;
+    }
+    if (!m_First.back())
+    {
+        m_Stream << ',';
+    }
+    m_First.back() = false;
+    newLine();
+}
+
+/**
+ * @brief Close the current object or array.
+ * @param bracket Closing bracket.
+ */
+void Tools::JsonWriter::close(char bracket)
+{
+    bool empty = m_First.back();
+    m_First.pop_back();
+    if (!empty)
+    {
+        newLine();
+    }
+    m_Stream << bracket;
+}
+
+/**
+ * @brief Start a new line, indented to the current level.
+ */
+void Tools::JsonWriter::newLine()
+{
+    m_Stream << '\n';
+    for (size_t i = 0; i < m_First.size(); ++i)
+    {
+        m_Stream << "  ";
+    }
+}
+
+/**
+ * @brief Write a quoted and escaped string.
+ * @param text String to write.
+ */
+void Tools::JsonWriter::writeString(std::string_view text)
+{
+    m_Stream << '"';
+    for (auto c : text)
+    {
+        switch (c)
+        {
+        case '"':
+            m_Stream << "\\\"";
+            break;
+        case '\\':
+            m_Stream << "\\\\";
+            break;
+        case '\n':
+            m_Stream << "\\n";
+            break;
+        case '\t':
+            m_Stream << "\\t";
+            break;
+        case '\r':
+            m_Stream << "\\r";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char escape[8];
+                std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned>(c));
+                m_Stream << escape;
+            }
+            else
+            {
+                m_Stream << c;
+            }
+            break;
+        }
+    }
+    m_Stream << '"';
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Tools {
+
+/**
+ * @brief Streaming JSON writer.
+ *
+ * The JsonWriter writes indented JSON to a stream. The separators between the members
+ * are inserted from a stack of the open objects and arrays.
+ */
+class JsonWriter
+{
+public:
+    JsonWriter(std::ostream& stream);
+    ~JsonWriter();
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    JsonWriter& key(std::string_view name);
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const char* text);
+    JsonWriter& value(double number);
+    JsonWriter& value(std::uint64_t number);
+    JsonWriter& value(std::int64_t number);
+    JsonWriter& value(bool flag);
+
+    template <typename T>
+    JsonWriter& member(std::string_view name, const T& content)
+    {
+        return key(name).value(content);
+    }
+
+protected:
+    void separate();
+    void close(char bracket);
+    void newLine();
+    void writeString(std::string_view text);
+
+    std::ostream& m_Stream;
+    std::vector<bool> m_First;
+    bool m_AfterKey;
+};
+
+}
@@ -0,0 +1,114 @@
+#include "Pipeline.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Pex/Binary.hpp"
+#include "Pex/FileReader.hpp"
+
+#include "Decompiler/AsmCoder.hpp"
+#include "Decompiler/FileWriter.hpp"
+#include "Decompiler/PscCoder.hpp"
+
+/**
+ * @brief Constructor
+ * @param papyrusDir Directory receiving the decompiled scripts.
+ * @param assemblyDir Directory receiving the disassembled scripts, empty to not disassemble.
+ */
+Tools::Pipeline::Pipeline(const std::filesystem::path &papyrusDir, const std::filesystem::path &assemblyDir) :
+    m_PapyrusDir(papyrusDir),
+    m_AssemblyDir(assemblyDir),
+    m_DisabledPasses(0)
+{
+}
+
+/**
+ * @brief Set the optional decompilation passes to skip.
+ * @param disabledPasses Mask of the passes, the bit N matching the pass N of PscDecompiler::getPasses.
+ */
+void Tools::Pipeline::disablePasses(std::uint32_t disabledPasses)
+{
+    m_DisabledPasses = disabledPasses;
+}
+
+/**
+ * @brief Decompile a script.
+ * The options are the defaults of the Champollion executable, except for the disabled passes.
+ *
+ * @param input Script to decompile.
+ * @return The status and the time spent, reading and writing included.
+ */
+Tools::Pipeline::Result Tools::Pipeline::process(const Input &input) const
+{
+    Result result;
+    result.failed = false;
+    auto start = std::chrono::steady_clock::now();
+    try
+    {
+        Pex::Binary pex;
+        Pex::FileReader reader(input.path.string());
+        reader.read(pex);
+        pex.sort();
+
+        if (!m_AssemblyDir.empty())
+        {
+            auto asmWriter = new Decompiler::FileWriter((m_AssemblyDir / input.relative).replace_extension(".pas").string());
+            Decompiler::AsmCoder asmCoder(asmWriter);
+            asmCoder.code(pex);
+            asmWriter->commit();
+        }
+
+        auto pscWriter = new Decompiler::FileWriter((m_PapyrusDir / input.relative).replace_extension(".psc").string());
+        Decompiler::PscCoder pscCoder(pscWriter, false, false, false, false, false, true, m_PapyrusDir.string());
+        pscCoder.disablePasses(m_DisabledPasses);
+        pscCoder.code(pex);
+        pscWriter->commit();
+    }
+    catch(const std::exception& ex)
+    {
+        result.failed = true;
+        result.error = ex.what();
+    }
+    result.time = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+/**
+ * @brief List the scripts of a corpus.
+ * @param paths PEX files, or directories searched recursively for PEX files.
+ * @return The scripts, sorted by relative path.
+ */
+std::vector<Tools::Pipeline::Input> Tools::Pipeline::listInputs(const std::vector<std::filesystem::path> &paths)
+{
+    std::vector<Input> inputs;
+    auto add = [&inputs](const std::filesystem::path& path, const std::filesystem::path& relative) {
+        inputs.push_back(Input{path, relative, static_cast<size_t>(std::filesystem::file_size(path))});
+    };
+    for (auto& path : paths)
+    {
+        if (std::filesystem::is_directory(path))
+        {
+            for (auto& entry : std::filesystem::recursive_directory_iterator(path))
+            {
+                auto extension = entry.path().extension().string();
+                std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+                if (entry.is_regular_file() && extension == ".pex")
+                {
+                    add(entry.path(), std::filesystem::relative(entry.path(), path));
+                }
+            }
+        }
+        else if (std::filesystem::exists(path))
+        {
+            add(path, path.filename());
+        }
+        else
+        {
+            throw std::runtime_error(path.string() + " doesn't exist");
+        }
+    }
+    std::sort(inputs.begin(), inputs.end(), [](const Input& left, const Input& right) {
+        return left.relative < right.relative;
+    });
+    return inputs;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Tools {
+
+/**
+ * @brief Read, decompile and write the scripts of a corpus, as the Champollion executable does.
+ *
+ * The decompiled scripts are written below the Papyrus directory, and the disassembled
+ * scripts below the assembly directory if one is given, with the relative path of the
+ * input file in the corpus.
+ */
+class Pipeline
+{
+public:
+    struct Input
+    {
+        std::filesystem::path path;
+        std::filesystem::path relative;
+        size_t size;
+    };
+
+    struct Result
+    {
+        bool failed;
+        std::string error;
+        std::chrono::steady_clock::duration time;
+    };
+
+    Pipeline(const std::filesystem::path& papyrusDir, const std::filesystem::path& assemblyDir);
+
+    void disablePasses(std::uint32_t disabledPasses);
+    Result process(const Input& input) const;
+
+    static std::vector<Input> listInputs(const std::vector<std::filesystem::path>& paths);
+
+protected:
+    std::filesystem::path m_PapyrusDir;
+    std::filesystem::path m_AssemblyDir;
+    std::uint32_t m_DisabledPasses;
+};
+
+}
@@ -0,0 +1,126 @@
+#include <filesystem>
+#include <iostream>
+namespace fs = std::filesystem;
+
+#include <boost/program_options.hpp>
+namespace options = boost::program_options;
+
+#include "Tools/Common/Generator.hpp"
+
+struct Params
+{
+    fs::path output;
+    size_t files = 1;
+    bool mixed = false;
+    Tools::Generator::Params shape;
+};
+
+bool getProgramOptions(int argc, char* argv[], Params& params)
+{
+    options::options_description desc("Champollion synthetic PEX generator");
+    desc.add_options()
+            ("help,h", "Display the help message")
+            ("output,o", options::value<std::string>(), "Directory receiving the files (default: current directory)")
+            ("files,n", options::value<size_t>(), "Number of files to generate (default 1)")
+            ("seed,s", options::value<std::uint32_t>(), "Seed of the first file, the next files use the following seeds (default 0)")
+            ("game,g", options::value<std::string>(), "skyrim, fallout4, starfield or mixed to cycle through the games (default skyrim)")
+            ("objects", options::value<size_t>(), "Number of objects in each file (default 1)")
+            ("states", options::value<size_t>(), "Number of named states in each object (default 1)")
+            ("functions", options::value<size_t>(), "Number of functions in the default state (default 8)")
+            ("instructions", options::value<size_t>(), "Approximate number of instructions per function, up to 60000 (default 100)")
+            ("depth", options::value<size_t>(), "Maximum nesting depth of the if and while blocks (default 3)")
+            ("strings", options::value<size_t>(), "Minimum size of the string table, up to 65535 (default 0)")
+            ("guards", options::value<size_t>(), "Number of guards in each object, Starfield only (default 0)")
+            ("structs", options::value<size_t>(), "Number of structs in each object, Fallout 4 and Starfield only (default 0)")
+            ("chain", options::value<size_t>(), "Length of the if/elseif chain of a DeepChain function, 0 for none (default 0)")
+            ("trivial", options::value<size_t>(), "Number of trivial functions in each object: empty, getters, setters and single calls (default 0)");
+    options::variables_map args;
+    try
+    {
+        options::store(options::parse_command_line(argc, argv, desc), args);
+        options::notify(args);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << desc << std::endl;
+        return false;
+    }
+    if (args.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return false;
+    }
+
+    params.output = args.count("output") ? fs::path(args["output"].as<std::string>()) : fs::current_path();
+    if (args.count("files"))
+    {
+        params.files = args["files"].as<size_t>();
+    }
+    if (args.count("seed"))
+    {
+        params.shape.seed = args["seed"].as<std::uint32_t>();
+    }
+    if (args.count("game"))
+    {
+        auto game = args["game"].as<std::string>();
+        if (game == "skyrim")
+        {
+            params.shape.game = Pex::Binary::SkyrimScript;
+        }
+        else if (game == "fallout4")
+        {
+            params.shape.game = Pex::Binary::Fallout4Script;
+        }
+        else if (game == "starfield")
+        {
+            params.shape.game = Pex::Binary::StarfieldScript;
+        }
+        else if (game == "mixed")
+        {
+            params.mixed = true;
+        }
+        else
+        {
+            std::cerr << "Unknown game " << game << std::endl;
+            return false;
+        }
+    }
+    auto size = [&args](const char* name, size_t& value) {
+        if (args.count(name))
+        {
+            value = args[name].as<size_t>();
+        }
+    };
+    size("objects", params.shape.objects);
+    size("states", params.shape.states);
+    size("functions", params.shape.functions);
+    size("instructions", params.shape.instructions);
+    size("depth", params.shape.depth);
+    size("strings", params.shape.strings);
+    size("guards", params.shape.guards);
+    size("structs", params.shape.structs);
+    size("chain", params.shape.chain);
+    size("trivial", params.shape.trivial);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    Params params;
+    if (!getProgramOptions(argc, argv, params))
+    {
+        return 1;
+    }
+    try
+    {
+        auto bytes = Tools::Generator::writeCorpus(params.output, params.shape, params.files, params.mixed);
+        std::cout << params.files << " files, " << bytes << " bytes written to " << params.output.string() << std::endl;
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
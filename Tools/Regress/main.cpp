@@ -0,0 +1,392 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+namespace fs = std::filesystem;
+
+#include <boost/program_options.hpp>
+namespace options = boost::program_options;
+
+#include "Decompiler/PscDecompiler.hpp"
+#include "Decompiler/TraceSink.hpp"
+
+#include "Tools/Common/Generator.hpp"
+#include "Tools/Common/Pipeline.hpp"
+
+struct Params
+{
+    std::vector<fs::path> inputs;
+    fs::path manifest;
+    fs::path baseline;
+    fs::path workDir;
+    bool synthetic = true;
+    bool record = false;
+    bool updateBaseline = false;
+    size_t repeat = 3;
+    double threshold = 0.25;
+    double minMs = 5;
+    std::uint32_t disabledPasses = 0;
+};
+
+/**
+ * @brief Hash the content of an output file.
+ * The carriage returns are skipped, the text files written on Windows hash as the others.
+ *
+ * @param path File to hash.
+ * @return The FNV-1a hash of the file, as 16 hexadecimal digits. Empty if the file does not exist.
+ */
+std::string hashFile(const fs::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return std::string();
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    std::uint64_t hash = 14695981039346656037ull;
+    for (auto c : content.str())
+    {
+        if (c != '\r')
+        {
+            hash ^= static_cast<std::uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+    }
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+    return text;
+}
+
+/**
+ * @brief Read a manifest or a baseline.
+ * Each line holds a value and a relative path separated by a space, the lines starting with # are comments.
+ */
+std::map<std::string, std::string> readEntries(const fs::path& path)
+{
+    std::map<std::string, std::string> entries;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        auto separator = line.find(' ');
+        if (line.empty() || line[0] == '#' || separator == std::string::npos)
+        {
+            continue;
+        }
+        entries[line.substr(separator + 1)] = line.substr(0, separator);
+    }
+    return entries;
+}
+
+void writeEntries(const fs::path& path, const std::string& comment, const std::map<std::string, std::string>& entries)
+{
+    if (path.has_parent_path())
+    {
+        fs::create_directories(path.parent_path());
+    }
+    std::ofstream file(path, std::ios::binary);
+    file << "# " << comment << '\n';
+    for (auto& entry : entries)
+    {
+        file << entry.second << ' ' << entry.first << '\n';
+    }
+    if (!file)
+    {
+        throw std::runtime_error("Unable to write " + path.string());
+    }
+}
+
+/**
+ * @brief Build the corpus: the synthetic scripts and the local PEX files.
+ * The shape of the synthetic scripts is part of the golden manifest, changing it requires recording the manifest again.
+ */
+std::vector<Tools::Pipeline::Input> makeCorpus(const Params& params)
+{
+    std::vector<Tools::Pipeline::Input> inputs;
+    auto add = [&inputs](const fs::path& root, const fs::path& prefix) {
+        for (auto& input : Tools::Pipeline::listInputs({root}))
+        {
+            input.relative = prefix / input.relative;
+            inputs.push_back(input);
+        }
+    };
+    if (params.synthetic)
+    {
+        auto dir = params.workDir / "corpus";
+        fs::remove_all(dir);
+        Tools::Generator::Params shape;
+        shape.seed = 100;
+        shape.functions = 10;
+        shape.instructions = 120;
+        shape.states = 2;
+        shape.structs = 1;
+        shape.guards = 2;
+        Tools::Generator::writeCorpus(dir / "mixed", shape, 45, true);
+        shape.seed = 200;
+        shape.functions = 2;
+        shape.instructions = 2000;
+        shape.depth = 4;
+        shape.chain = 300;
+        Tools::Generator::writeCorpus(dir / "large", shape, 3, true);
+        shape = Tools::Generator::Params();
+        shape.seed = 300;
+        shape.functions = 2;
+        shape.instructions = 30;
+        shape.trivial = 28;
+        Tools::Generator::writeCorpus(dir / "trivial", shape, 6, true);
+        add(dir, "synthetic");
+    }
+    for (auto& input : params.inputs)
+    {
+        add(input, fs::path("local") / input.filename());
+    }
+    return inputs;
+}
+
+bool getProgramOptions(int argc, char* argv[], Params& params)
+{
+    options::options_description desc("Champollion golden output regression test");
+    desc.add_options()
+            ("help,h", "Display the help message")
+            ("manifest,m", options::value<std::string>(), "Manifest of the output hashes")
+            ("baseline,b", options::value<std::string>(), "Timing baseline, recorded if it does not exist")
+            ("input,i", options::value<std::vector<std::string>>(), "Directories of local PEX files added to the corpus")
+            ("no-synthetic", "Do not add the synthetic scripts to the corpus")
+            ("record", "Record the manifest and the baseline instead of checking them")
+            ("update-baseline", "Record the baseline again after checking the manifest")
+            ("work-dir", options::value<std::string>(), "Directory receiving the corpus and the decompiled scripts (default: temporary directory)")
+            ("repeat", options::value<size_t>(), "Number of runs, the fastest time of each file is kept (default 3)")
+            ("threshold", options::value<double>(), "Slowdown failing the test, 0.25 fails the files 25% slower than the baseline (default 0.25)")
+            ("min-ms", options::value<double>(), "Files faster than this in the baseline are not checked for slowdowns, in milliseconds (default 5)")
+            ("disable-pass", options::value<std::vector<std::string>>(), "Skip an optional decompilation pass, can be repeated. The output must match the same manifest");
+    options::variables_map args;
+    try
+    {
+        options::store(options::parse_command_line(argc, argv, desc), args);
+        options::notify(args);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << desc << std::endl;
+        return false;
+    }
+    if (args.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return false;
+    }
+    if (!args.count("manifest"))
+    {
+        std::cerr << "No manifest given" << std::endl;
+        return false;
+    }
+    params.manifest = fs::path(args["manifest"].as<std::string>());
+    if (args.count("baseline"))
+    {
+        params.baseline = fs::path(args["baseline"].as<std::string>());
+    }
+    if (args.count("input"))
+    {
+        for (auto& input : args["input"].as<std::vector<std::string>>())
+        {
+            params.inputs.push_back(fs::path(input));
+        }
+    }
+    params.synthetic = args.count("no-synthetic") == 0;
+    params.record = args.count("record") != 0;
+    params.updateBaseline = args.count("update-baseline") != 0;
+    params.workDir = args.count("work-dir") ? fs::path(args["work-dir"].as<std::string>())
+                                            : fs::temp_directory_path() / "ChampollionRegress";
+    if (args.count("repeat"))
+    {
+        params.repeat = std::max<size_t>(args["repeat"].as<size_t>(), 1);
+    }
+    if (args.count("threshold"))
+    {
+        params.threshold = args["threshold"].as<double>();
+    }
+    if (args.count("min-ms"))
+    {
+        params.minMs = args["min-ms"].as<double>();
+    }
+    if (args.count("disable-pass"))
+    {
+        auto& passes = Decompiler::PscDecompiler::getPasses();
+        for (auto& name : args["disable-pass"].as<std::vector<std::string>>())
+        {
+            size_t i = 0;
+            while (i < passes.size() && (!passes[i].optional || name != passes[i].name))
+            {
+                ++i;
+            }
+            if (i == passes.size())
+            {
+                std::cerr << name << " is not an optional decompilation pass" << std::endl;
+                return false;
+            }
+            params.disabledPasses |= 1u << i;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    Params params;
+    if (!getProgramOptions(argc, argv, params))
+    {
+        return 2;
+    }
+
+    std::vector<Tools::Pipeline::Input> inputs;
+    try
+    {
+        inputs = makeCorpus(params);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+
+    // Decompile the corpus, keeping the fastest time of each file
+    fs::remove_all(params.workDir / "psc");
+    fs::remove_all(params.workDir / "pas");
+    Tools::Pipeline pipeline(params.workDir / "psc", params.workDir / "pas");
+    pipeline.disablePasses(params.disabledPasses);
+    std::vector<double> times(inputs.size(), 0);
+    size_t failures = 0;
+    for (size_t run = 0; run < params.repeat; ++run)
+    {
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            auto result = pipeline.process(inputs[i]);
+            if (result.failed && run == 0)
+            {
+                std::cerr << "ERROR: " << inputs[i].relative.generic_string() << " : " << result.error << std::endl;
+                ++failures;
+            }
+            auto ms = std::chrono::duration<double, std::milli>(result.time).count();
+            times[i] = run == 0 ? ms : std::min(times[i], ms);
+        }
+    }
+    Decompiler::TraceSink::instance().flush();
+
+    std::map<std::string, std::string> hashes;
+    std::map<std::string, std::string> timings;
+    double total = 0;
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        for (auto extension : {"psc", "pas"})
+        {
+            auto relative = (fs::path(extension) / inputs[i].relative).replace_extension(std::string(".") + extension);
+            auto hash = hashFile(params.workDir / relative);
+            if (!hash.empty())
+            {
+                hashes[relative.generic_string()] = hash;
+            }
+        }
+        char ms[32];
+        std::snprintf(ms, sizeof(ms), "%.3f", times[i]);
+        timings[inputs[i].relative.generic_string()] = ms;
+        total += times[i];
+    }
+
+    try
+    {
+        if (params.record)
+        {
+            writeEntries(params.manifest, "Champollion golden output: FNV-1a hash and path of each decompiled file", hashes);
+            std::cout << hashes.size() << " hashes recorded in " << params.manifest.string() << std::endl;
+        }
+        if (!params.baseline.empty() && (params.record || params.updateBaseline || !fs::exists(params.baseline)))
+        {
+            writeEntries(params.baseline, "Champollion timing baseline: time in milliseconds and path of each input", timings);
+            std::cout << "Timing baseline recorded in " << params.baseline.string() << std::endl;
+            params.baseline.clear();
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+    if (params.record)
+    {
+        return failures ? 1 : 0;
+    }
+
+    // Output drift
+    size_t drifts = 0;
+    auto expected = readEntries(params.manifest);
+    if (expected.empty())
+    {
+        std::cerr << "ERROR: the manifest " << params.manifest.string() << " is empty or missing" << std::endl;
+        return 2;
+    }
+    for (auto& entry : expected)
+    {
+        auto it = hashes.find(entry.first);
+        if (it == hashes.end())
+        {
+            std::cerr << "MISSING: " << entry.first << std::endl;
+            ++drifts;
+        }
+        else if (it->second != entry.second)
+        {
+            std::cerr << "DRIFT: " << entry.first << " " << it->second << " expected " << entry.second << std::endl;
+            ++drifts;
+        }
+    }
+    for (auto& entry : hashes)
+    {
+        if (expected.find(entry.first) == expected.end())
+        {
+            std::cerr << "NEW: " << entry.first << " is not in the manifest" << std::endl;
+            ++drifts;
+        }
+    }
+
+    // Slowdowns, the fast files are dominated by the noise
+    size_t slowdowns = 0;
+    if (!params.baseline.empty())
+    {
+        double baselineTotal = 0;
+        for (auto& entry : readEntries(params.baseline))
+        {
+            auto it = timings.find(entry.first);
+            if (it == timings.end())
+            {
+                continue;
+            }
+            auto before = std::stod(entry.second);
+            auto after = std::stod(it->second);
+            baselineTotal += before;
+            if (before >= params.minMs && after > before * (1 + params.threshold))
+            {
+                std::cerr << "SLOWER: " << entry.first << " " << after << " ms, baseline " << before << " ms" << std::endl;
+                ++slowdowns;
+            }
+        }
+        std::cout << "Total time " << total << " ms, baseline " << baselineTotal << " ms" << std::endl;
+        if (baselineTotal > 0 && total > baselineTotal * (1 + params.threshold))
+        {
+            std::cerr << "SLOWER: the corpus is " << (total / baselineTotal - 1) * 100 << "% slower than the baseline" << std::endl;
+            ++slowdowns;
+        }
+    }
+
+    std::cout << inputs.size() << " files, " << hashes.size() << " outputs checked: " << failures << " failures, "
+              << drifts << " drifts, " << slowdowns << " slowdowns" << std::endl;
+    return failures || drifts || slowdowns ? 1 : 0;
+}
@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+namespace fs = std::filesystem;
+
+#include <boost/program_options.hpp>
+namespace options = boost::program_options;
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "Decompiler/TraceSink.hpp"
+#include "Decompiler/Version.hpp"
+
+#include "Tools/Common/Generator.hpp"
+#include "Tools/Common/JsonWriter.hpp"
+#include "Tools/Common/Pipeline.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+struct Params
+{
+    std::vector<fs::path> inputs;
+    fs::path workDir;
+    std::string output;
+    size_t maxWorkers = 0;
+    size_t generate = 200;
+    bool writeAssembly = false;
+};
+
+struct Run
+{
+    size_t workers = 0;
+    double seconds = 0;
+    size_t files = 0;
+    size_t failed = 0;
+    double p50Ms = 0;
+    double p99Ms = 0;
+    // Peak of the whole process up to the end of the run, including the previous runs
+    std::uint64_t processPeakRss = 0;
+};
+
+/**
+ * @brief Get the peak resident set size of the process.
+ * The peak never decreases: it is the largest of the run and of all the runs before it, made
+ * with fewer workers.
+ *
+ * @return The peak, in bytes.
+ */
+std::uint64_t getPeakRss()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+/**
+ * @brief Get a percentile of the latencies.
+ * @param latencies Sorted latencies, in milliseconds.
+ * @param percentile Percentile, in [0, 100].
+ * @return The latency, nearest rank.
+ */
+double getPercentile(const std::vector<double>& latencies, double percentile)
+{
+    if (latencies.empty())
+    {
+        return 0;
+    }
+    auto rank = static_cast<size_t>(percentile / 100 * latencies.size() + 0.5);
+    return latencies[std::min(std::max<size_t>(rank, 1), latencies.size()) - 1];
+}
+
+/**
+ * @brief Decompile the whole corpus with a number of workers.
+ * The workers take the files in order from a shared counter, each file is read, decompiled and written.
+ */
+Run runCorpus(const Tools::Pipeline& pipeline, const std::vector<Tools::Pipeline::Input>& inputs, size_t workers)
+{
+    std::vector<Tools::Pipeline::Result> results(inputs.size());
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        for (auto i = next++; i < inputs.size(); i = next++)
+        {
+            results[i] = pipeline.process(inputs[i]);
+        }
+    };
+
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers; ++i)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    Decompiler::TraceSink::instance().flush();
+
+    Run run;
+    run.workers = workers;
+    run.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    run.files = inputs.size();
+    std::vector<double> latencies;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        if (results[i].failed)
+        {
+            ++run.failed;
+            std::cerr << "ERROR: " << inputs[i].path.string() << " : " << results[i].error << std::endl;
+        }
+        latencies.push_back(std::chrono::duration<double, std::milli>(results[i].time).count());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    run.p50Ms = getPercentile(latencies, 50);
+    run.p99Ms = getPercentile(latencies, 99);
+    run.processPeakRss = getPeakRss();
+    return run;
+}
+
+void writeResults(std::ostream& stream, const std::vector<Run>& runs, size_t files, size_t bytes)
+{
+    Tools::JsonWriter json(stream);
+    json.beginObject();
+    json.member("version", CHAMPOLLION_VERSION_STRING);
+    json.member("hardware_threads", std::uint64_t(std::thread::hardware_concurrency()));
+    json.key("corpus").beginObject();
+    json.member("files", std::uint64_t(files));
+    json.member("bytes", std::uint64_t(bytes));
+    json.endObject();
+    json.key("runs").beginArray();
+    for (auto& run : runs)
+    {
+        auto filesPerSecond = run.files / run.seconds;
+        json.beginObject();
+        json.member("workers", std::uint64_t(run.workers));
+        json.member("seconds", run.seconds);
+        json.member("files_per_s", filesPerSecond);
+        json.member("mb_per_s", bytes / run.seconds / 1e6);
+        json.member("p50_ms", run.p50Ms);
+        json.member("p99_ms", run.p99Ms);
+        json.member("process_peak_rss_bytes", run.processPeakRss);
+        json.member("efficiency", filesPerSecond / (runs.front().files / runs.front().seconds) / run.workers);
+        json.member("failed", std::uint64_t(run.failed));
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+}
+
+bool getProgramOptions(int argc, char* argv[], Params& params)
+{
+    options::options_description desc("Champollion throughput and scaling harness");
+    desc.add_options()
+            ("help,h", "Display the help message")
+            ("input,i", options::value<std::vector<std::string>>(), "PEX files or directories of the corpus (default: a generated corpus)")
+            ("generate,g", options::value<size_t>(), "Number of files of the generated corpus (default 200)")
+            ("workers,w", options::value<size_t>(), "Largest number of workers, the runs use 1, 2, 4... up to this number (default: hardware threads)")
+            ("work-dir", options::value<std::string>(), "Directory receiving the generated corpus and the decompiled scripts (default: temporary directory)")
+            ("asm,a", "Also write the disassembled scripts")
+            ("output,o", options::value<std::string>(), "Write the JSON results to this file instead of the standard output");
+    options::variables_map args;
+    try
+    {
+        options::store(options::parse_command_line(argc, argv, desc), args);
+        options::notify(args);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << desc << std::endl;
+        return false;
+    }
+    if (args.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return false;
+    }
+    if (args.count("input"))
+    {
+        for (auto& input : args["input"].as<std::vector<std::string>>())
+        {
+            params.inputs.push_back(fs::path(input));
+        }
+    }
+    if (args.count("generate"))
+    {
+        params.generate = args["generate"].as<size_t>();
+    }
+    params.maxWorkers = args.count("workers") ? args["workers"].as<size_t>() : std::thread::hardware_concurrency();
+    params.maxWorkers = std::max<size_t>(params.maxWorkers, 1);
+    params.workDir = args.count("work-dir") ? fs::path(args["work-dir"].as<std::string>())
+                                            : fs::temp_directory_path() / "ChampollionScaling";
+    params.writeAssembly = args.count("asm") != 0;
+    if (args.count("output"))
+    {
+        params.output = args["output"].as<std::string>();
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    Params params;
+    if (!getProgramOptions(argc, argv, params))
+    {
+        return 1;
+    }
+
+    std::vector<Tools::Pipeline::Input> inputs;
+    try
+    {
+        if (params.inputs.empty())
+        {
+            // Mixed games and sizes, a few large functions among many small ones
+            Tools::Generator::Params shape;
+            shape.seed = 1000;
+            shape.functions = 12;
+            shape.instructions = 150;
+            shape.states = 2;
+            shape.structs = 1;
+            shape.guards = 1;
+            auto corpus = params.workDir / "corpus";
+            fs::remove_all(corpus);
+            Tools::Generator::writeCorpus(corpus, shape, params.generate, true);
+            params.inputs.push_back(corpus);
+        }
+        inputs = Tools::Pipeline::listInputs(params.inputs);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (inputs.empty())
+    {
+        std::cerr << "No input file given" << std::endl;
+        return 1;
+    }
+    size_t bytes = 0;
+    for (auto& input : inputs)
+    {
+        bytes += input.size;
+    }
+
+    Tools::Pipeline pipeline(params.workDir / "psc", params.writeAssembly ? params.workDir / "pas" : fs::path());
+    // Warm up the caches and the output directories, with a single worker to not raise the peak RSS
+    runCorpus(pipeline, inputs, 1);
+
+    std::vector<Run> runs;
+    for (size_t workers = 1; ; workers *= 2)
+    {
+        workers = std::min(workers, params.maxWorkers);
+        runs.push_back(runCorpus(pipeline, inputs, workers));
+        auto& run = runs.back();
+        std::cerr << workers << " workers: " << run.files / run.seconds << " files/s, p50 " << run.p50Ms
+                  << " ms, p99 " << run.p99Ms << " ms" << std::endl;
+        if (workers == params.maxWorkers)
+        {
+            break;
+        }
+    }
+
+    if (params.output.empty())
+    {
+        writeResults(std::cout, runs, inputs.size(), bytes);
+    }
+    else
+    {
+        std::ofstream file(params.output);
+        writeResults(file, runs, inputs.size(), bytes);
+    }
+    return runs.back().failed ? 1 : 0;
+}